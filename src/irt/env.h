@@ -5,6 +5,8 @@
 
 IMPORT void print(const char* str, size_t length);
 IMPORT double pow(double, double);
+// Milliseconds on a monotonic clock, such as 'performance.now()'.
+IMPORT double now();
 
 [[noreturn]] IMPORT void throwError(const char* msg,
                                     size_t msg_length,
@@ -171,7 +171,12 @@ struct FreeChunk {
 };
 
 page_count_t GrowMemory(page_count_t count) {
+#if defined(__wasm64__)
+  // memory64 counts pages with 64-bit integers, and returns -1 on failure.
+  return static_cast<page_count_t>(__builtin_wasm_memory_grow(0, count));
+#else
   return __builtin_wasm_grow_memory(count);
+#endif
 }
 
 bool Initialize(size_t size) {
@@ -0,0 +1,86 @@
+#ifndef Minisat_Profile_h
+#define Minisat_Profile_h
+
+#include "irt/env.h"
+#include "minisat/mtl/Vec.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Phase timers, built with 'MINISAT_PROFILING' (the GN arg 'profiling'):
+
+// The phases of the search that are timed. websat.js names them in this order.
+enum ProfilePhase {
+  Phase_Solve,
+  Phase_Propagate,
+  Phase_Analyze,
+  Phase_PickBranchLit,
+  Phase_ReduceDB,
+  Phase_Simplify,
+  Phase_GarbageCollect,
+  Phase_Count
+};
+
+// The time spent in each phase, by the imported 'now()' clock. Phases nest (propagation runs
+// inside simplification, for one), and each is timed with the phases inside it.
+struct Profile {
+  // A phase beginning or ending at 'time' (in milliseconds).
+  struct Event {
+    double time;
+    uint32_t phase;
+    uint32_t begin;
+  };
+  enum { Trace_Capacity = 1 << 16 };
+
+  // The total time of each phase in milliseconds, and the number of times it ran:
+  double total[Phase_Count] = {};
+  uint64_t count[Phase_Count] = {};
+  // The number of events since tracing was enabled. While tracing, the last 'Trace_Capacity' of
+  // them are in 'events', event 'i' at 'i % Trace_Capacity'.
+  uint64_t recorded = 0;
+  vec<Event> events;
+
+  bool tracing() const { return events.size() > 0; }
+  void setTracing(bool enable) {
+    events.clear(true);
+    if (enable)
+      events.growTo(Trace_Capacity);
+    recorded = 0;
+  }
+  void record(double time, ProfilePhase phase, bool begin) {
+    Event& e = events[recorded++ % Trace_Capacity];
+    e.time = time;
+    e.phase = phase;
+    e.begin = begin;
+  }
+};
+
+// Times the phase of the enclosing scope.
+class ProfileScope {
+  Profile& profile;
+  ProfilePhase phase;
+  double start;
+
+ public:
+  ProfileScope(Profile& p, ProfilePhase ph) : profile(p), phase(ph), start(now()) {
+    if (profile.tracing())
+      profile.record(start, phase, true);
+  }
+  ~ProfileScope() {
+    double end = now();
+    profile.total[phase] += end - start;
+    profile.count[phase]++;
+    if (profile.tracing())
+      profile.record(end, phase, false);
+  }
+};
+
+#if defined(MINISAT_PROFILING)
+#define PROFILE_PHASE(phase) ProfileScope profile_scope_(profile, phase)
+#else
+#define PROFILE_PHASE(phase) ((void)0)
+#endif
+
+}
+
+#endif
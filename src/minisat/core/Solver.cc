@@ -36,12 +36,23 @@ static double opt_random_var_freq = 0;
 static double opt_random_seed = 91648253;
 static int opt_ccmin_mode = 2;
 static int opt_phase_saving = 2;
+static bool opt_use_target = true;
+static int opt_rephase_first = 1000;
+static double opt_walk_effort = 0.1;
 static bool opt_rnd_init_act = false;
 static bool opt_luby_restart = true;
 static int opt_restart_first = 100;
 static double opt_restart_inc = 2;
+static bool opt_reuse_trail = true;
+static double opt_vivify_effort = 0.1;
+static bool opt_vivify_irred = false;
+static double opt_probe_effort = 0.05;
+static bool opt_use_equiv = true;
+static int opt_cube_candidates = 64;
 static double opt_garbage_frac = 0.20;
 static int opt_min_learnts_lim = 0;
+static int opt_compact_interval = 0;
+static int opt_inplace_gc_lim = 256;
 
 
 //=================================================================================================
@@ -56,12 +67,24 @@ Solver::Solver() :
     luby_restart(opt_luby_restart),
     ccmin_mode(opt_ccmin_mode),
     phase_saving(opt_phase_saving),
+    use_target(opt_use_target),
+    rephase_first(opt_rephase_first),
+    walk_effort(opt_walk_effort),
     rnd_pol(false),
     rnd_init_act(opt_rnd_init_act),
     garbage_frac(opt_garbage_frac),
     min_learnts_lim(opt_min_learnts_lim),
+    compact_interval(opt_compact_interval),
+    inplace_gc_lim(opt_inplace_gc_lim),
     restart_first(opt_restart_first),
     restart_inc(opt_restart_inc),
+    reuse_trail(opt_reuse_trail),
+    vivify_effort(opt_vivify_effort),
+    vivify_irred(opt_vivify_irred),
+    probe_effort(opt_probe_effort),
+    use_equiv(opt_use_equiv),
+    cube_candidates(opt_cube_candidates),
+    extend_model(true),
     // Parameters (the rest):
     //
     learntsize_factor(1.0 / 3.0),
@@ -87,9 +110,22 @@ Solver::Solver() :
     learnts_literals(0),
     max_literals(0),
     tot_literals(0),
-
+    vivified_clauses(0),
+    vivified_lits(0),
+    probed_lits(0),
+    failed_lits(0),
+    implied_lits(0),
+    equiv_lits(0),
+    rephases(0),
+    walks(0),
+    walk_flips(0),
+    restarts(0),
+    reduce_dbs(0),
+    garbage_collections(0),
+
+    xors_changed(false),
     watches(WatcherDeleted(ca)),
-    order_heap(VarOrderLt(activity)),
+    order_heap(VarOrderPrio(activity)),
     ok(true),
     cla_inc(1),
     var_inc(1),
@@ -99,6 +135,15 @@ Solver::Solver() :
     progress_estimate(0),
     remove_satisfied(true),
     next_var(0),
+    vivify_props(0),
+    probe_props(0),
+    probe_next(0),
+    walk_props(0),
+    target_assigned(0),
+    best_assigned(0),
+    next_rephase(opt_rephase_first),
+
+    next_compact(opt_compact_interval),
 
     // Resource constraints:
     //
@@ -125,13 +170,20 @@ Var Solver::newVar(lbool upol, bool dvar) {
 
   watches.init(mkLit(v, false));
   watches.init(mkLit(v, true ));
+#if defined(MINISAT_PACKED_VARS)
+  var_state.insert(v, VarState{mkVarData(CRef_Undef, 0), l_Undef, true, 0});
+#else
   assigns.insert(v, l_Undef);
   vardata.insert(v, mkVarData(CRef_Undef, 0));
-  activity.insert(v, rnd_init_act ? drand(random_seed) * 0.00001 : 0);
   seen.insert(v, 0);
   polarity.insert(v, true);
+#endif
+  activity.insert(v, rnd_init_act ? drand(random_seed) * 0.00001 : 0);
   user_pol.insert(v, upol);
+  target_pol.insert(v, true);
+  best_pol.insert(v, true);
   decision.reserve(v);
+  equiv.insert(v, lit_Undef);
   trail.capacity(v+1);
   setDecisionVar(v, dvar);
   return v;
@@ -142,19 +194,21 @@ Var Solver::newVar(lbool upol, bool dvar) {
 // releases of the same variable).
 void Solver::releaseVar(Lit l) {
   if (value(l) == l_Undef){
-    vec<Lit> c;
+    svec<Lit, 1> c;
     c.push(l);
-    addClause(std::move(c));
+    addClause_(c);
     released_vars.push(var(l));
   }
 }
 
-bool Solver::addClause(vec<Lit> ps) {
+bool Solver::addClause_(vec<Lit>& ps) {
   assert(decisionLevel() == 0);
   if (!ok)
     return false;
 
   // Check if clause is satisfied and remove false/duplicate literals:
+  for (int i = 0; i < ps.size(); i++)
+    ps[i] = repr(ps[i]);
   sort(ps);
   Lit p; int i, j;
   for (i = j = 0, p = lit_Undef; i < ps.size(); i++) {
@@ -179,12 +233,111 @@ bool Solver::addClause(vec<Lit> ps) {
   return true;
 }
 
+bool Solver::addAtMostK_(vec<Lit>& ps, int k) {
+  assert(decisionLevel() == 0);
+  if (!ok)
+    return false;
+
+  // Remove assigned literals, and complementary pairs, of which exactly one is true. (Literals
+  // that are the same, also by substitution, are kept; each of them counts.)
+  for (int i = 0; i < ps.size(); i++)
+    ps[i] = repr(ps[i]);
+  sort(ps);
+  int i, j;
+  for (i = j = 0; i < ps.size(); i++) {
+    if (value(ps[i]) == l_False)
+      continue;
+    if (value(ps[i]) == l_True)
+      k--;
+    else if (j > 0 && ps[j-1] == ~ps[i]) {
+      j--;
+      k--;
+    } else
+      ps[j++] = ps[i];
+  }
+  ps.shrink(i - j);
+
+  if (k < 0)
+    return ok = false;
+  if (ps.size() <= k)
+    return true;
+
+  if (k == 0) {
+    for (int i = 0; i < ps.size(); i++) {
+      if (value(ps[i]) == l_Undef)
+        uncheckedEnqueue(~ps[i]);
+    }
+    return ok = (propagate() == CRef_Undef);
+  }
+
+  int ci = cards.size();
+  cards.push();
+  cards.last().k = k;
+  ps.copyTo(cards.last().lits);
+  for (int i = 0; i < ps.size(); i++) {
+    card_occs.reserve(mkLit(var(ps[i]), true));
+    lazy_reason.reserve(var(ps[i]), -1);
+    card_occs[ps[i]].push(ci);
+  }
+  return true;
+}
+
+bool Solver::addXor_(vec<Lit>& ps, bool rhs) {
+  assert(decisionLevel() == 0);
+  if (!ok)
+    return false;
+
+  // Fold the signs and the assigned variables into 'rhs', and remove pairs of the same variable:
+  int i, j;
+  for (i = j = 0; i < ps.size(); i++) {
+    Lit p = repr(ps[i]);
+    rhs ^= sign(p);
+    if (value(var(p)) == l_Undef)
+      ps[j++] = mkLit(var(p));
+    else
+      rhs ^= value(var(p)) == l_True;
+  }
+  ps.shrink(i - j);
+  sort(ps);
+  for (i = j = 0; i < ps.size(); i++) {
+    if (j > 0 && ps[j-1] == ps[i])
+      j--;
+    else
+      ps[j++] = ps[i];
+  }
+  ps.shrink(i - j);
+
+  if (ps.size() == 0)
+    return ok = !rhs;
+
+  if (ps.size() == 1) {
+    uncheckedEnqueue(ps[0] ^ !rhs);
+    return ok = (propagate() == CRef_Undef);
+  }
+
+  xors.push();
+  xors.last().rhs = rhs;
+  for (int i = 0; i < ps.size(); i++) {
+    Var v = var(ps[i]);
+    xors.last().vars.push(v);
+    xor_col.reserve(v, -1);
+    lazy_reason.reserve(v, -1);
+    if (xor_col[v] < 0) {
+      xor_col[v] = xor_vars.size();
+      xor_vars.push(v);
+      xor_watches.push();
+    }
+  }
+  xors_changed = true;
+  return true;
+}
+
 
 void Solver::attachClause(CRef cr) {
   const Clause& c = ca[cr];
   assert(c.size() > 1);
-  watches[~c[0]].push(Watcher(cr, c[1]));
-  watches[~c[1]].push(Watcher(cr, c[0]));
+  watches[~c[0]].push(Watcher(cr, c[1], c.size() == 2));
+  watches[~c[1]].push(Watcher(cr, c[0], c.size() == 2));
   if (c.learnt()) {
     num_learnts++;
     learnts_literals += c.size();
@@ -201,8 +354,9 @@ void Solver::detachClause(CRef cr, bool strict) {
 
   // Strict or lazy detaching:
   if (strict){
-    remove(watches[~c[0]], Watcher(cr, c[1]));
-    remove(watches[~c[1]], Watcher(cr, c[0]));
+    WatchList ws0 = watches[~c[0]], ws1 = watches[~c[1]];
+    remove(ws0, Watcher(cr, c[1], c.size() == 2));
+    remove(ws1, Watcher(cr, c[0], c.size() == 2));
   }else{
     watches.smudge(~c[0]);
     watches.smudge(~c[1]);
@@ -222,7 +376,9 @@ void Solver::removeClause(CRef cr) {
   detachClause(cr);
   // Don't leave pointers to free'd memory!
   if (locked(c)) {
-    vardata[var(c[0])].reason = CRef_Undef;
+    // The implied literal is the only true one, and need not be first in a binary clause:
+    Lit implied = value(c[0]) == l_True ? c[0] : c[1];
+    vardata[var(implied)].reason = CRef_Undef;
   }
   c.mark(1); 
   ca.free(cr);
@@ -237,17 +393,34 @@ bool Solver::satisfied(const Clause& c) const {
 }
 
 // Revert to the state at given level (keeping all assignment at 'level' but not beyond).
+// Assignments made by root-level inprocessing pass 'save_phases = false' so that they don't
+// override the phases saved by search.
 //
-void Solver::cancelUntil(int level) {
+void Solver::cancelUntil(int level, bool save_phases) {
   if (decisionLevel() <= level)
     return;
 
   for (int c = trail.size()-1; c >= trail_lim[level]; c--) {
     Var x = var(trail[c]);
     assigns [x] = l_Undef;
-    if (phase_saving > 1 || (phase_saving == 1 && c > trail_lim.last()))
+    if (save_phases &&
+        (phase_saving > 1 || (phase_saving == 1 && c > trail_lim.last())))
       polarity[x] = sign(trail[c]);
     insertVarOrder(x);
+
+    // Uncount 'trail[c]' from the cardinality constraints, if it was propagated:
+    if (cards.size() > 0 && card_occs.has(trail[c])) {
+      const vec<int>& occs = card_occs[trail[c]];
+      for (int i = 0; i < occs.size(); i++) {
+        vec<Lit>& counted = cards[occs[i]].counted;
+        if (counted.size() > 0 && counted.last() == trail[c])
+          counted.pop();
+      }
+    }
+  }
+  while (xor_reason_pos.size() > 0 && xor_reason_pos.last() >= trail_lim[level]) {
+    xor_reason_pos.pop();
+    xor_reason_rows.shrink(xor_matrix.words);
   }
   qhead = trail_lim[level];
   trail.shrink(trail.size() - trail_lim[level]);
@@ -258,6 +431,7 @@ void Solver::cancelUntil(int level) {
 // Major methods:
 
 Lit Solver::pickBranchLit() {
+  PROFILE_PHASE(Phase_PickBranchLit);
   Var next = var_Undef;
 
   // Random decision:
@@ -285,7 +459,263 @@ Lit Solver::pickBranchLit() {
     return mkLit(next, user_pol[next] == l_True);
   if (rnd_pol)
     return mkLit(next, drand(random_seed) < 0.5);
-  return mkLit(next, polarity[next]);
+  return mkLit(next, use_target ? target_pol[next] : polarity[next]);
+}
+
+// A restart would make the same decisions again as long as they are more active than the
+// best unassigned variable, so the levels of those decisions are kept. Assumption levels are
+// always kept.
+//
+int Solver::reuseTrailLevel(const vec<Lit>& assumptions) {
+  while (!order_heap.empty() &&
+         (value(order_heap[0]) != l_Undef || !decision[order_heap[0]]))
+    order_heap.removeMin();
+  if (order_heap.empty())
+    return decisionLevel();
+
+  Var next = order_heap[0];
+  int lev = assumptions.size() < decisionLevel() ? assumptions.size() : decisionLevel();
+  while (lev < decisionLevel() && activity[var(trail[trail_lim[lev]])] > activity[next])
+    lev++;
+  return lev;
+}
+
+void Solver::updateTargetPhases(int assigned) {
+  if (assigned > target_assigned) {
+    for (int i = 0; i < assigned; i++)
+      target_pol[var(trail[i])] = sign(trail[i]);
+    target_assigned = assigned;
+  }
+  if (assigned > best_assigned) {
+    for (int i = 0; i < assigned; i++)
+      best_pol[var(trail[i])] = sign(trail[i]);
+    best_assigned = assigned;
+  }
+}
+
+/*_________________________________________________________________________________________________
+|
+|  rephase : [void]  ->  [void]
+|  
+|  Description:
+|    Reset the saved and target phases of all variables. After the original (all false) and the
+|    inverted phases, the cycle alternates the best phases and those of a local search (walk) from
+|    them with the original, random and inverted ones. The best phases are cleared, so that they
+|    record the best trail since this call.
+|________________________________________________________________________________________________@*/
+void Solver::rephase() {
+  static const char first[] = "OI";
+  static const char cycle[] = "BWOBWRBWI";
+  char kind = rephases < 2 ? first[rephases] : cycle[(rephases - 2) % (sizeof(cycle) - 1)];
+
+  if (kind == 'W' && walk_effort > 0) {
+    localSearch((int64_t)((propagations - walk_props) * walk_effort));
+    walk_props = propagations;
+  }
+
+  for (Var v = 0; v < nVars(); v++) {
+    switch (kind) {
+      case 'O': polarity[v] = true; break;
+      case 'I': polarity[v] = false; break;
+      case 'B': polarity[v] = best_pol[v]; break;
+      case 'R': polarity[v] = drand(random_seed) < 0.5; break;
+    }
+    target_pol[v] = polarity[v];
+  }
+
+  rephases++;
+  target_assigned = 0;
+  best_assigned = 0;
+  next_rephase = conflicts + rephase_first * (rephases + 1);
+}
+
+/*_________________________________________________________________________________________________
+|
+|  localSearch : (flips : int64_t)  ->  [lbool]
+|  
+|  Description:
+|    ProbSAT: flip a variable of a random falsified clause, chosen with a probability that falls
+|    exponentially with its break count (the number of clauses it would falsify), with the base
+|    picked by the average clause size as in CaDiCaL. The variables assigned at the root level stay
+|    fixed; the other decision levels are ignored, so this may run between restarts. Cardinality and
+|    XOR constraints are not searched on, only checked before a model is returned.
+|________________________________________________________________________________________________@*/
+lbool Solver::localSearch(int64_t flips) {
+  if (!ok)
+    return l_False;
+  walks++;
+
+  // The current assignment (1 for true), starting from the saved phases:
+  vec<char> val(nVars());
+  for (Var v = 0; v < nVars(); v++)
+    val[v] = value(v) != l_Undef && level(v) == 0 ? value(v) == l_True : !polarity[v];
+
+  // The clauses that are not satisfied at the root level, and the clauses of each literal that
+  // is not fixed as 'occs[start[toInt(p)] .. start[toInt(p)+1]-1]':
+  vec<CRef> cls;
+  vec<int> start(2 * nVars() + 1, 0);
+  vec<int> occs;
+  int64_t nlits = 0;
+  for (int i = 0; i < clauses.size(); i++) {
+    const Clause& c = ca[clauses[i]];
+    if (isRemoved(clauses[i]))
+      continue;
+    bool root_sat = false;
+    for (int j = 0; j < c.size(); j++) {
+      if (value(c[j]) == l_True && level(var(c[j])) == 0)
+        root_sat = true;
+    }
+    if (root_sat)
+      continue;
+    cls.push(clauses[i]);
+    for (int j = 0; j < c.size(); j++) {
+      if (value(c[j]) == l_Undef || level(var(c[j])) > 0)
+        start[toInt(c[j]) + 1]++;
+    }
+    nlits += c.size();
+  }
+  for (int i = 0; i < 2 * nVars(); i++)
+    start[i + 1] += start[i];
+  vec<int> pos;
+  start.copyTo(pos);
+  occs.growTo(start.last());
+  for (int i = 0; i < cls.size(); i++) {
+    const Clause& c = ca[cls[i]];
+    for (int j = 0; j < c.size(); j++) {
+      if (value(c[j]) == l_Undef || level(var(c[j])) > 0)
+        occs[pos[toInt(c[j])]++] = i;
+    }
+  }
+
+  // The number of true literals of each clause, and the falsified clauses:
+  vec<int> num_true(cls.size(), 0);
+  vec<int> unsat;
+  vec<int> unsat_pos(cls.size(), -1);
+  for (int i = 0; i < cls.size(); i++) {
+    const Clause& c = ca[cls[i]];
+    for (int j = 0; j < c.size(); j++)
+      num_true[i] += val[var(c[j])] != sign(c[j]);
+    if (num_true[i] == 0) {
+      unsat_pos[i] = unsat.size();
+      unsat.push(i);
+    }
+  }
+
+  static const double sizes[] = {0, 3, 4, 5, 6, 7};
+  static const double bases[] = {2.0, 2.5, 2.85, 3.7, 5.1, 7.4};
+  double avg_size = cls.size() > 0 ? (double)nlits / cls.size() : 0;
+  int k = 0;
+  while (k < 5 && avg_size >= sizes[k + 1])
+    k++;
+  double prob[64];
+  for (int b = 0; b < 64; b++)
+    prob[b] = pow(bases[k], -b);
+
+  // The best assignment is 'val' with the flips in 'since_best' undone, or 'best' once those
+  // grow too many:
+  int best_unsat = unsat.size();
+  vec<Var> since_best;
+  vec<char> best;
+  bool in_best = false;
+  vec<Var> cand;
+  vec<double> score;
+  for (; flips > 0 && unsat.size() > 0; flips--) {
+    const Clause& c = ca[cls[unsat[irand(random_seed, unsat.size())]]];
+    cand.clear();
+    score.clear();
+    double sum = 0;
+    for (int i = 0; i < c.size(); i++) {
+      if (value(c[i]) != l_Undef && level(var(c[i])) == 0)
+        continue;
+      // Flipping 'c[i]' to true breaks the clauses in which '~c[i]' is the only true literal:
+      Lit t = ~c[i];
+      int breaks = 0;
+      for (int j = start[toInt(t)]; j < start[toInt(t) + 1]; j++)
+        breaks += num_true[occs[j]] == 1;
+      cand.push(var(c[i]));
+      score.push(prob[breaks < 64 ? breaks : 63]);
+      sum += score.last();
+    }
+    assert(cand.size() > 0);
+    double r = drand(random_seed) * sum;
+    int i = 0;
+    while (i < cand.size() - 1 && (r -= score[i]) >= 0)
+      i++;
+
+    Var v = cand[i];
+    val[v] = !val[v];
+    Lit p = mkLit(v, !val[v]);
+    for (int j = start[toInt(p)]; j < start[toInt(p) + 1]; j++) {
+      int ci = occs[j];
+      if (num_true[ci]++ == 0) {
+        unsat_pos[unsat.last()] = unsat_pos[ci];
+        unsat[unsat_pos[ci]] = unsat.last();
+        unsat.pop();
+        unsat_pos[ci] = -1;
+      }
+    }
+    for (int j = start[toInt(~p)]; j < start[toInt(~p) + 1]; j++) {
+      int ci = occs[j];
+      if (--num_true[ci] == 0) {
+        unsat_pos[ci] = unsat.size();
+        unsat.push(ci);
+      }
+    }
+    walk_flips++;
+
+    if (unsat.size() < best_unsat) {
+      best_unsat = unsat.size();
+      since_best.clear();
+      in_best = false;
+    } else if (!in_best) {
+      since_best.push(v);
+      if (since_best.size() > nVars()) {
+        val.copyTo(best);
+        for (int j = 0; j < since_best.size(); j++)
+          best[since_best[j]] = !best[since_best[j]];
+        since_best.clear();
+        in_best = true;
+      }
+    }
+  }
+  if (in_best) {
+    best.moveTo(val);
+  } else {
+    for (int i = 0; i < since_best.size(); i++)
+      val[since_best[i]] = !val[since_best[i]];
+  }
+
+  for (Var v = 0; v < nVars(); v++) {
+    if (value(v) == l_Undef || level(v) > 0)
+      polarity[v] = target_pol[v] = !val[v];
+  }
+  if (best_unsat > 0)
+    return l_Undef;
+
+  for (int i = 0; i < cards.size(); i++) {
+    const vec<Lit>& lits = cards[i].lits;
+    int n = 0;
+    for (int j = 0; j < lits.size(); j++)
+      n += val[var(lits[j])] != sign(lits[j]);
+    if (n > cards[i].k)
+      return l_Undef;
+  }
+  for (int i = 0; i < xors.size(); i++) {
+    const vec<Var>& vars = xors[i].vars;
+    bool parity = false;
+    for (int j = 0; j < vars.size(); j++)
+      parity ^= val[vars[j]];
+    if (parity != xors[i].rhs)
+      return l_Undef;
+  }
+
+  model.clear();
+  model.growTo(nVars());
+  for (Var v = 0; v < nVars(); v++)
+    model[v] = lbool::fromBool(val[v]);
+  if (extend_model)
+    extendModel();
+  return l_True;
 }
 
 /*_________________________________________________________________________________________________
@@ -306,6 +736,7 @@ Lit Solver::pickBranchLit() {
 |  
 |________________________________________________________________________________________________@*/
 void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel) {
+  PROFILE_PHASE(Phase_Analyze);
   int pathC = 0;
   Lit p = lit_Undef;
 
@@ -316,6 +747,8 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel) {
 
   do {
     assert(confl != CRef_Undef); // (otherwise should be UIP)
+    if (p != lit_Undef)
+      confl = explain(var(p));
     Clause& c = ca[confl];
 
     if (c.learnt())
@@ -348,7 +781,7 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel) {
   //
   int i, j;
   out_learnt.copyTo(analyze_toclear);
-  if (ccmin_mode == 2){
+  if (ccmin_mode >= 2){
     for (i = j = 1; i < out_learnt.size(); i++) {
       if (reason(var(out_learnt[i])) == CRef_Undef ||
           !litRedundant(out_learnt[i]))
@@ -360,7 +793,7 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel) {
       if (reason(x) == CRef_Undef)
         out_learnt[j++] = out_learnt[i];
       else {
-        Clause& c = ca[reason(var(out_learnt[i]))];
+        Clause& c = ca[explain(x)];
         for (int k = 1; k < c.size(); k++)
           if (!seen[var(c[k])] && level(var(c[k])) > 0) {
             out_learnt[j++] = out_learnt[i];
@@ -373,6 +806,10 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel) {
 
   max_literals += out_learnt.size();
   out_learnt.shrink(i - j);
+  if (ccmin_mode >= 4)
+    shrinkLearnt(out_learnt);
+  if (ccmin_mode >= 3 && out_learnt.size() <= 30)
+    binaryMinimize(out_learnt);
   tot_literals += out_learnt.size();
 
   // Find correct backtrack level:
@@ -403,7 +840,7 @@ bool Solver::litRedundant(Lit p) {
   assert(seen[var(p)] == seen_undef || seen[var(p)] == seen_source);
   assert(reason(var(p)) != CRef_Undef);
 
-  Clause* c = &ca[reason(var(p))];
+  Clause* c = &ca[explain(var(p))];
   vec<ShrinkStackElem>& stack = analyze_stack;
   stack.clear();
 
@@ -436,7 +873,7 @@ bool Solver::litRedundant(Lit p) {
       stack.push(ShrinkStackElem(i, p));
       i  = 0;
       p  = l;
-      c  = &ca[reason(var(p))];
+      c  = &ca[explain(var(p))];
     } else {
       // Finished with current element 'p' and reason 'c':
       if (seen[var(p)] == seen_undef){
@@ -451,7 +888,7 @@ bool Solver::litRedundant(Lit p) {
       // Continue with top element on stack:
       i  = stack.last().i;
       p  = stack.last().l;
-      c  = &ca[reason(var(p))];
+      c  = &ca[explain(var(p))];
       
       stack.pop();
     }
@@ -459,6 +896,114 @@ bool Solver::litRedundant(Lit p) {
   return true;
 }
 
+/*_________________________________________________________________________________________________
+|
+|  shrinkLearnt : (out_learnt : vec<Lit>&)  ->  [void]
+|  
+|  Description:
+|    Shrink a minimized learnt clause block by block. The literals of a decision level below the
+|    conflict level are resolved on, latest first, until only their unique implication point is
+|    left. That succeeds if each literal from a lower level met on the way is in the clause, or is
+|    redundant by 'litRedundant()'; then the block is replaced by the implication point.
+|________________________________________________________________________________________________@*/
+void Solver::shrinkLearnt(vec<Lit>& out_learnt) {
+  // Group the literals by decision level, highest first:
+  sort((Lit*)out_learnt + 1, out_learnt.size() - 1, LitLevelGt(vardata));
+
+  int i, j;
+  for (i = j = 1; i < out_learnt.size(); ) {
+    int lev = level(var(out_learnt[i]));
+    int end = i + 1;
+    while (end < out_learnt.size() && level(var(out_learnt[end])) == lev)
+      end++;
+
+    Lit uip = end - i > 1 ? shrinkLevel(out_learnt, i, end, lev) : lit_Undef;
+    if (uip != lit_Undef) {
+      out_learnt[j++] = uip;
+    } else {
+      for (int k = i; k < end; k++)
+        out_learnt[j++] = out_learnt[k];
+    }
+    i = end;
+  }
+  out_learnt.shrink(i - j);
+}
+
+Lit Solver::shrinkLevel(const vec<Lit>& out_learnt, int begin, int end, int lev) {
+  enum { seen_undef = 0, seen_source = 1, seen_removable = 2, seen_failed = 3, seen_block = 4 };
+
+  shrink_toclear.clear();
+  for (int i = begin; i < end; i++) {
+    seen[var(out_learnt[i])] |= seen_block;
+    shrink_toclear.push(out_learnt[i]);
+  }
+
+  int open = end - begin;
+  bool failed = false;
+  Lit uip = lit_Undef;
+  for (int t = trail_lim[lev] - 1; !failed; t--) {
+    Var v = var(trail[t]);
+    if (!(seen[v] & seen_block))
+      continue;
+    if (--open == 0) {
+      uip = ~trail[t];
+      break;
+    }
+
+    assert(reason(v) != CRef_Undef);
+    const Clause& c = ca[explain(v)];
+    for (int k = 1; k < c.size() && !failed; k++) {
+      Var x = var(c[k]);
+      if (level(x) == lev) {
+        if (!(seen[x] & seen_block)) {
+          seen[x] |= seen_block;
+          shrink_toclear.push(c[k]);
+          open++;
+        }
+      } else if (level(x) > 0 && seen[x] != seen_source && seen[x] != seen_removable) {
+        failed = reason(x) == CRef_Undef || seen[x] == seen_failed || !litRedundant(c[k]);
+      }
+    }
+  }
+
+  for (int i = 0; i < shrink_toclear.size(); i++)
+    seen[var(shrink_toclear[i])] &= ~seen_block;
+
+  if (uip != lit_Undef && seen[var(uip)] != seen_source) {
+    if (seen[var(uip)] == seen_undef)
+      analyze_toclear.push(uip);
+    seen[var(uip)] = seen_source;
+  }
+  return uip;
+}
+
+void Solver::binaryMinimize(vec<Lit>& out_learnt) {
+  enum { seen_in_clause = 4 };
+
+  for (int i = 1; i < out_learnt.size(); i++)
+    seen[var(out_learnt[i])] |= seen_in_clause;
+
+  // A binary clause '(out_learnt[0] | imp)' with 'imp' true resolves '~imp' away:
+  const WatchList ws = watches[~out_learnt[0]];
+  for (int i = 0; i < ws.size(); i++) {
+    if (!ws[i].binary() || ca[ws[i].cref()].mark() == 1)
+      continue;
+    Lit imp = ws[i].blocker;
+    if ((seen[var(imp)] & seen_in_clause) && value(imp) == l_True)
+      seen[var(imp)] &= ~seen_in_clause;
+  }
+
+  int i, j;
+  for (i = j = 1; i < out_learnt.size(); i++) {
+    Var v = var(out_learnt[i]);
+    if (seen[v] & seen_in_clause) {
+      seen[v] &= ~seen_in_clause;
+      out_learnt[j++] = out_learnt[i];
+    }
+  }
+  out_learnt.shrink(i - j);
+}
+
 /*_________________________________________________________________________________________________
 |
 |  analyzeFinal : (p : Lit)  ->  [void]
@@ -484,7 +1029,7 @@ void Solver::analyzeFinal(Lit p, LSet& out_conflict) {
         assert(level(x) > 0);
         out_conflict.insert(~trail[i]);
       } else {
-        Clause& c = ca[reason(x)];
+        Clause& c = ca[explain(x)];
         for (int j = 1; j < c.size(); j++)
           if (level(var(c[j])) > 0)
             seen[var(c[j])] = 1;
@@ -517,12 +1062,13 @@ void Solver::uncheckedEnqueue(Lit p, CRef from) {
 |      * the propagation queue is empty, even if there was a conflict.
 |________________________________________________________________________________________________@*/
 CRef Solver::propagate() {
+  PROFILE_PHASE(Phase_Propagate);
   CRef confl = CRef_Undef;
   int num_props = 0;
 
   while (qhead < trail.size()) {
     Lit p = trail[qhead++];     // 'p' is enqueued fact to propagate.
-    vec<Watcher>& ws = watches.lookup(p);
+    WatchList ws = watches.lookup(p);
     Watcher *i, *j, *end;
     num_props++;
 
@@ -534,10 +1080,23 @@ CRef Solver::propagate() {
         continue;
       }
 
+      CRef cr = i->cref();
+      if (i->binary()) {
+        // Binary clause; its literals are left in any order (see 'explain()'):
+        *j++ = *i++;
+        if (value(blocker) == l_False) {
+          confl = cr;
+          qhead = trail.size();
+          while (i < end)
+            *j++ = *i++;
+        } else
+          uncheckedEnqueue(blocker, cr);
+        continue;
+      }
+
       // Make sure the false literal is data[1]:
-      CRef cr = i->cref;
-      Clause& c = ca[cr];
       Lit false_lit = ~p;
+      Clause& c = ca[cr];
       if (c[0] == false_lit) {
         c[0] = c[1];
         c[1] = false_lit;
@@ -547,7 +1106,7 @@ CRef Solver::propagate() {
 
       // If 0th watch is true, then clause is already satisfied.
       Lit     first = c[0];
-      Watcher w     = Watcher(cr, first);
+      Watcher w     = Watcher(cr, first, false);
       if (first != blocker && value(first) == l_True) {
         *j++ = w; continue;
       }
@@ -575,6 +1134,11 @@ CRef Solver::propagate() {
     NextClause:;
     }
     ws.shrink(i - j);
+
+    if (cards.size() > 0 && confl == CRef_Undef)
+      confl = propagateCards(p);
+    if (xor_matrix.rows() > 0 && confl == CRef_Undef)
+      confl = propagateXors(p);
   }
   propagations += num_props;
   simpDB_props -= num_props;
@@ -582,6 +1146,325 @@ CRef Solver::propagate() {
   return confl;
 }
 
+/*_________________________________________________________________________________________________
+|
+|  propagateCards : (p : Lit)  ->  [CRef]
+|  
+|  Description:
+|    Count 'p' in the cardinality constraints it is in. A constraint with 'k' true literals
+|    implies the negation of the rest, with the reason 'CRef_Lazy'; one with more is a conflict,
+|    which is returned as an (unattached) clause.
+|________________________________________________________________________________________________@*/
+CRef Solver::propagateCards(Lit p) {
+  if (!card_occs.has(p))
+    return CRef_Undef;
+
+  const vec<int>& occs = card_occs[p];
+  for (int i = 0; i < occs.size(); i++) {
+    Card& c = cards[occs[i]];
+    c.counted.push(p);
+    if (c.counted.size() > c.k) {
+      svec<Lit, 16> ps;
+      for (int j = 0; j < c.counted.size(); j++)
+        ps.push(~c.counted[j]);
+      CRef cr = ca.alloc(ps, false);
+      explanations.push(cr);
+      qhead = trail.size();
+      return cr;
+    }
+    if (c.counted.size() == c.k) {
+      for (int j = 0; j < c.lits.size(); j++) {
+        if (value(c.lits[j]) == l_Undef) {
+          lazy_reason[var(c.lits[j])] = occs[i];
+          uncheckedEnqueue(~c.lits[j], CRef_Lazy);
+        }
+      }
+    }
+  }
+  return CRef_Undef;
+}
+
+/*_________________________________________________________________________________________________
+|
+|  explain : (x : Var)  ->  [CRef]
+|  
+|  Description:
+|    Return the reason of 'x', with the literal of 'x' first (binary clauses are left unordered by
+|    'propagate()'). A 'CRef_Lazy' reason is replaced by the clause of the literal of
+|    'x' and the false literals of the rest of its constraint: for a cardinality constraint, the
+|    negations of the 'k' literals that were counted first (those are still counted, since they
+|    precede 'x' on the trail), and for an XOR constraint, the other variables of the row copy.
+|________________________________________________________________________________________________@*/
+CRef Solver::explain(Var x) {
+  if (reason(x) != CRef_Lazy) {
+    CRef cr = reason(x);
+    if (cr != CRef_Undef) {
+      Clause& c = ca[cr];
+      if (c.size() == 2 && var(c[0]) != x) {
+        c[1] = c[0];
+        c[0] = mkLit(x, value(x) == l_False);
+      }
+    }
+    return cr;
+  }
+
+  svec<Lit, 16> ps;
+  ps.push(mkLit(x, value(x) == l_False));
+  if (lazy_reason[x] >= 0) {
+    const Card& c = cards[lazy_reason[x]];
+    for (int i = 0; i < c.k; i++)
+      ps.push(~c.counted[i]);
+  } else {
+    const uint64_t* row = &xor_reason_rows[~lazy_reason[x] * xor_matrix.words];
+    for (int k = 0; k < xor_matrix.words; k++) {
+      for (uint64_t w = row[k]; w != 0; w &= w - 1) {
+        Var y = xor_vars[k * 64 + __builtin_ctzll(w)];
+        if (y != x)
+          ps.push(mkLit(y, value(y) == l_True));
+      }
+    }
+  }
+  CRef cr = ca.alloc(ps, false);
+  explanations.push(cr);
+  vardata[x].reason = cr;
+  return cr;
+}
+
+void Solver::sweepExplanations() {
+  int i, j;
+  for (i = j = 0; i < explanations.size(); i++) {
+    Clause& c = ca[explanations[i]];
+    if (locked(c))
+      explanations[j++] = explanations[i];
+    else {
+      c.mark(1);
+      ca.free(explanations[i]);
+    }
+  }
+  explanations.shrink(i - j);
+}
+
+/*_________________________________________________________________________________________________
+|
+|  buildXorMatrix : ()  ->  [bool]
+|  
+|  Description:
+|    Bring the XOR constraints into reduced row echelon form by Gauss-Jordan elimination, with
+|    the variables assigned at level 0 left out. Rows that become empty are dropped, and so are
+|    rows of a single variable, which is assigned instead. Returns false if a row becomes '0 = 1'.
+|________________________________________________________________________________________________@*/
+bool Solver::buildXorMatrix() {
+  assert(decisionLevel() == 0);
+  xors_changed = false;
+
+  XorMatrix& m = xor_matrix;
+  m.words = (xor_vars.size() + 63) / 64;
+  m.bits.clear();
+  m.bits.growTo(xors.size() * m.words, 0);
+  m.rhs.clear();
+  for (int i = 0; i < xors.size(); i++) {
+    uint64_t* row = &m.bits[i * m.words];
+    bool rhs = xors[i].rhs;
+    for (int j = 0; j < xors[i].vars.size(); j++) {
+      Var v = xors[i].vars[j];
+      int col = xor_col[v];
+      if (value(v) == l_Undef)
+        row[col / 64] ^= (uint64_t)1 << (col % 64);
+      else
+        rhs ^= value(v) == l_True;
+    }
+    m.rhs.push(rhs);
+  }
+
+  // Eliminate the first column of each row from all other rows:
+  m.basic.clear();
+  m.basic.growTo(m.rows(), -1);
+  for (int r = 0; r < m.rows(); r++) {
+    const uint64_t* row = m.row(r);
+    int k = 0;
+    while (k < m.words && row[k] == 0)
+      k++;
+    if (k == m.words) {
+      if (m.rhs[r])
+        return false;
+      continue;
+    }
+    int col = m.basic[r] = k * 64 + __builtin_ctzll(row[k]);
+    for (int s = 0; s < m.rows(); s++) {
+      uint64_t* other = m.row(s);
+      if (s == r || !XorMatrix::has(other, col))
+        continue;
+      for (int k = 0; k < m.words; k++)
+        other[k] ^= row[k];
+      m.rhs[s] ^= m.rhs[r];
+    }
+  }
+
+  // Keep the rows of two or more variables, and watch the second one:
+  int i, j;
+  m.watch.clear();
+  for (i = j = 0; i < m.rows(); i++) {
+    if (m.basic[i] < 0)
+      continue;
+    m.basic[j] = m.basic[i];
+    m.rhs[j] = m.rhs[i];
+    if (i != j)
+      memcpy(m.row(j), m.row(i), m.words * sizeof(uint64_t));
+    int second = xorWatchCandidate(j, m.basic[j]);
+    if (second < 0) {
+      uncheckedEnqueue(mkLit(xor_vars[m.basic[j]], !m.rhs[j]));
+      continue;
+    }
+    m.watch.push(second);
+    j++;
+  }
+  m.bits.shrink((i - j) * m.words);
+  m.rhs.shrink(i - j);
+  m.basic.shrink(i - j);
+
+  xor_watches.clear();
+  xor_watches.growTo(xor_vars.size());
+  for (int r = 0; r < m.rows(); r++) {
+    xor_watches[m.basic[r]].push(r);
+    xor_watches[m.watch[r]].push(r);
+  }
+  xor_reason_rows.clear();
+  xor_reason_pos.clear();
+  return true;
+}
+
+/*_________________________________________________________________________________________________
+|
+|  propagateXors : (p : Lit)  ->  [CRef]
+|  
+|  Description:
+|    Update the rows that watch the column of 'p'. While a row has two unassigned columns, it
+|    watches two of them, one of which is its basic column: a watch that gets assigned moves to
+|    another unassigned column, and if that was the basic column, the new one is made basic by
+|    eliminating it from the other rows. So the basic columns are kept unassigned as long as the
+|    rows allow, and a row that implies a variable (or is a conflict) does so without having to
+|    add up rows. Implied variables get the reason 'CRef_Lazy', with a copy of the row.
+|________________________________________________________________________________________________@*/
+CRef Solver::propagateXors(Lit p) {
+  if (!xor_col.has(var(p)) || xor_col[var(p)] < 0)
+    return CRef_Undef;
+
+  int col = xor_col[var(p)];
+  XorMatrix& m = xor_matrix;
+  vec<int>& ws = xor_watches[col];
+  CRef confl = CRef_Undef;
+  int i, j;
+  for (i = j = 0; i < ws.size(); i++) {
+    int r = ws[i];
+    if (confl != CRef_Undef) {
+      ws[j++] = r;
+      continue;
+    }
+    bool basic = m.basic[r] == col;
+    if (!basic && m.watch[r] != col)
+      continue;
+
+    int next = xorWatchCandidate(r, basic ? m.watch[r] : m.basic[r]);
+    if (value(xor_vars[next]) == l_Undef) {
+      if (basic)
+        confl = pivotXor(r, next);
+      else
+        m.watch[r] = next;
+      xor_watches[next].push(r);
+      continue;
+    }
+    ws[j++] = r;
+    confl = impliedXor(r);
+  }
+  ws.shrink(i - j);
+
+  if (confl != CRef_Undef)
+    qhead = trail.size();
+  return confl;
+}
+
+CRef Solver::pivotXor(int r, int col) {
+  XorMatrix& m = xor_matrix;
+  m.basic[r] = col;
+  const uint64_t* row = m.row(r);
+  CRef confl = CRef_Undef;
+  for (int s = 0; s < m.rows(); s++) {
+    uint64_t* other = m.row(s);
+    if (s == r || !XorMatrix::has(other, col))
+      continue;
+    for (int k = 0; k < m.words; k++)
+      other[k] ^= row[k];
+    m.rhs[s] ^= m.rhs[r];
+    if (XorMatrix::has(other, m.watch[s]))
+      continue;
+
+    // The watch of 's' was eliminated:
+    m.watch[s] = xorWatchCandidate(s, m.basic[s]);
+    xor_watches[m.watch[s]].push(s);
+    if (confl == CRef_Undef && value(xor_vars[m.watch[s]]) != l_Undef)
+      confl = impliedXor(s);
+  }
+  return confl;
+}
+
+CRef Solver::impliedXor(int r) {
+  const uint64_t* row = xor_matrix.row(r);
+  int words = xor_matrix.words;
+  bool parity = xor_matrix.rhs[r];
+  Var implied = var_Undef;
+  for (int k = 0; k < words; k++) {
+    for (uint64_t w = row[k]; w != 0; w &= w - 1) {
+      Var x = xor_vars[k * 64 + __builtin_ctzll(w)];
+      if (value(x) != l_Undef)
+        parity ^= value(x) == l_True;
+      else if (implied == var_Undef)
+        implied = x;
+      else
+        return CRef_Undef;
+    }
+  }
+
+  if (implied != var_Undef) {
+    lazy_reason[implied] = ~xor_reason_pos.size();
+    xor_reason_pos.push(trail.size());
+    for (int k = 0; k < words; k++)
+      xor_reason_rows.push(row[k]);
+    uncheckedEnqueue(mkLit(implied, !parity), CRef_Lazy);
+    return CRef_Undef;
+  }
+  if (!parity)
+    return CRef_Undef;
+
+  svec<Lit, 16> ps;
+  for (int k = 0; k < words; k++) {
+    for (uint64_t w = row[k]; w != 0; w &= w - 1) {
+      Var x = xor_vars[k * 64 + __builtin_ctzll(w)];
+      ps.push(mkLit(x, value(x) == l_True));
+    }
+  }
+  CRef cr = ca.alloc(ps, false);
+  explanations.push(cr);
+  return cr;
+}
+
+int Solver::xorWatchCandidate(int r, int skip) {
+  const uint64_t* row = xor_matrix.row(r);
+  int best = -1;
+  for (int k = 0; k < xor_matrix.words; k++) {
+    for (uint64_t w = row[k]; w != 0; w &= w - 1) {
+      int col = k * 64 + __builtin_ctzll(w);
+      if (col == skip)
+        continue;
+      Var x = xor_vars[col];
+      if (value(x) == l_Undef)
+        return col;
+      if (best < 0 || level(x) > level(xor_vars[best]))
+        best = col;
+    }
+  }
+  return best;
+}
+
 /*_________________________________________________________________________________________________
 |
 |  reduceDB : ()  ->  [void]
@@ -590,21 +1473,39 @@ CRef Solver::propagate() {
 |    Remove half of the learnt clauses, minus the clauses locked by the current assignment. Locked
 |    clauses are clauses that are reason to some assignment. Binary clauses are never removed.
 |________________________________________________________________________________________________@*/
-struct reduceDB_lt { 
-  ClauseAllocator& ca;
-  reduceDB_lt(ClauseAllocator& ca_) : ca(ca_) {}
-  bool operator () (CRef x, CRef y) { 
-    return ca[x].size() > 2 &&
-        (ca[y].size() == 2 || ca[x].activity() < ca[y].activity());
-  } 
+// The order in which 'reduceDB()' considers learnt clauses for removal: binary clauses last,
+// the others by activity. (Activities are non-negative, so their bit patterns order like the
+// floats themselves.)
+struct reduceDB_key {
+  uint32_t key;
+  CRef cr;
+
+  reduceDB_key() {}
+  reduceDB_key(Clause& c, CRef cr_) : cr(cr_) {
+    if (c.size() == 2)
+      key = UINT32_MAX;
+    else
+      memcpy(&key, &c.activity(), sizeof(key));
+  }
 };
 
 void Solver::reduceDB() {
+  PROFILE_PHASE(Phase_ReduceDB);
   int i, j;
+  reduce_dbs++;
+  sweepExplanations();
   // Remove any clause below this activity
   double extra_lim = cla_inc / learnts.size();
 
-  sort(learnts, reduceDB_lt(ca));
+  // Sort on keys gathered up front, without going through the clause arena:
+  vec<reduceDB_key> ks;
+  ks.capacity(learnts.size());
+  for (i = 0; i < learnts.size(); i++)
+    ks.push_(reduceDB_key(ca[learnts[i]], learnts[i]));
+  radixSort(ks, [](const reduceDB_key& k) { return k.key; });
+  for (i = 0; i < ks.size(); i++)
+    learnts[i] = ks[i].cr;
+
   // Don't delete binary or locked clauses. From the rest, delete clauses from the first half
   // and clauses with activity smaller than 'extra_lim':
   for (i = j = 0; i < learnts.size(); i++) {
@@ -615,7 +1516,12 @@ void Solver::reduceDB() {
       learnts[j++] = learnts[i];
   }
   learnts.shrink(i - j);
-  checkGarbage();
+  if (compact_interval > 0 && conflicts >= next_compact) {
+    garbageCollect();
+    next_compact = conflicts + compact_interval;
+  } else {
+    checkGarbage();
+  }
 }
 
 void Solver::removeSatisfied(vec<CRef>& cs) {
@@ -640,24 +1546,16 @@ void Solver::removeSatisfied(vec<CRef>& cs) {
 }
 
 
-void Solver::rebuildOrderHeap() {
-  vec<Var> vs;
-  for (Var v = 0; v < nVars(); v++) {
-    if (decision[v] && value(v) == l_Undef)
-      vs.push(v);
-  }
-  order_heap.build(vs);
-}
-
 /*_________________________________________________________________________________________________
 |
 |  simplify : [void]  ->  [bool]
 |  
 |  Description:
-|    Simplify the clause database according to the current top-level assigment. Currently, the only
-|    thing done here is the removal of satisfied clauses, but more things can be put here.
+|    Simplify the clause database according to the current top-level assigment. Satisfied clauses
+|    are removed, and the binary implication graph is probed (see 'probe()').
 |________________________________________________________________________________________________@*/
 bool Solver::simplify() {
+  PROFILE_PHASE(Phase_Simplify);
   assert(decisionLevel() == 0);
 
   if (!ok || propagate() != CRef_Undef)
@@ -687,15 +1585,21 @@ bool Solver::simplify() {
     trail.shrink(i - j);
     qhead = trail.size();
     
-    for (int i = 0; i < released_vars.size(); i++)
+    // (A released variable is assigned, so it may still be in the order heap, where it is
+    // skipped lazily; it must be out of the heap before it is reused.)
+    for (int i = 0; i < released_vars.size(); i++) {
       seen[released_vars[i]] = 0;
+      if (order_heap.inHeap(released_vars[i]))
+        order_heap.remove(released_vars[i]);
+    }
 
     // Released variables are now ready to be reused:
     append(released_vars, free_vars);
     released_vars.clear();
   }
+  if (probe_effort > 0 && !probe())
+    return ok = false;
   checkGarbage();
-  rebuildOrderHeap();
 
   simpDB_assigns = nAssigns();
   // (shouldn't depend on stats really, but it will do for now)
@@ -704,6 +1608,420 @@ bool Solver::simplify() {
   return true;
 }
 
+/*_________________________________________________________________________________________________
+|
+|  vivify : [void]  ->  [bool]
+|  
+|  Description:
+|    Shorten clauses at the root level. The negations of the literals of a clause are assigned one
+|    by one; a literal that becomes false is dropped, and once a literal becomes true or the
+|    propagation conflicts, the remaining literals are redundant. Learnt clauses are visited most
+|    active first, and each clause is vivified at most once. The pass may spend 'vivify_effort'
+|    times the propagations made by search since the previous pass.
+|________________________________________________________________________________________________@*/
+struct vivify_lt {
+  ClauseAllocator& ca;
+  vivify_lt(ClauseAllocator& ca_) : ca(ca_) {}
+  bool operator () (CRef x, CRef y) {
+    return ca[x].activity() > ca[y].activity();
+  }
+};
+
+bool Solver::vivify() {
+  // Wait until the budget at least pays for scanning the candidates:
+  uint64_t budget = (propagations - vivify_props) * vivify_effort;
+  if (budget < num_learnts + (vivify_irred && remove_satisfied ? num_clauses : 0))
+    return true;
+
+  // A restart may have kept part of the trail:
+  cancelUntil(0);
+  if (!ok || propagate() != CRef_Undef)
+    return ok = false;
+
+  vec<CRef> cands;
+  for (int i = 0; i < learnts.size(); i++) {
+    const Clause& c = ca[learnts[i]];
+    if (!c.vivified() && c.size() > 2)
+      cands.push(learnts[i]);
+  }
+  sort(cands, vivify_lt(ca));
+  if (vivify_irred && remove_satisfied) {
+    for (int i = 0; i < clauses.size(); i++) {
+      const Clause& c = ca[clauses[i]];
+      if (!c.vivified() && c.size() > 2)
+        cands.push(clauses[i]);
+    }
+  }
+
+  uint64_t limit = propagations + budget;
+  int units = trail.size();
+  for (int i = 0; i < cands.size() && propagations < limit; i++) {
+    if (!vivifyClause(cands[i]))
+      return ok = false;
+  }
+
+  // Clauses that were shortened to units have been freed:
+  if (trail.size() > units) {
+    int i, j;
+    for (i = j = 0; i < learnts.size(); i++) {
+      if (!isRemoved(learnts[i]))
+        learnts[j++] = learnts[i];
+    }
+    learnts.shrink(i - j);
+    for (i = j = 0; i < clauses.size(); i++) {
+      if (!isRemoved(clauses[i]))
+        clauses[j++] = clauses[i];
+    }
+    clauses.shrink(i - j);
+  }
+
+  vivify_props = propagations;
+  return true;
+}
+
+bool Solver::vivifyClause(CRef cr) {
+  Clause& c = ca[cr];
+  if (isRemoved(cr) || satisfied(c))
+    return true;
+  c.vivified(true);
+
+  // The clause must not take part in propagating its own negation:
+  detachClause(cr, true);
+  newDecisionLevel();
+
+  int i, j;
+  for (i = j = 0; i < c.size(); i++) {
+    Lit p = c[i];
+    if (value(p) == l_False)
+      continue;
+    c[j++] = p;
+
+    // Implied by the negation of the literals before it:
+    if (value(p) == l_True)
+      break;
+    uncheckedEnqueue(~p);
+    if (propagate() != CRef_Undef)
+      break;
+  }
+  cancelUntil(0, false);
+
+  int removed = c.size() - j;
+  if (removed > 0) {
+    vivified_clauses++;
+    vivified_lits += removed;
+    c.shrink(removed);
+    if (!c.learnt() && c.has_extra())
+      c.calcAbstraction();
+  }
+
+  if (c.size() == 1) {
+    // Already detached, so only free it:
+    Lit unit = c[0];
+    c.mark(1);
+    ca.free(cr);
+    uncheckedEnqueue(unit);
+    return propagate() == CRef_Undef;
+  }
+
+  attachClause(cr);
+  return true;
+}
+
+/*_________________________________________________________________________________________________
+|
+|  probe : [void]  ->  [bool]
+|  
+|  Description:
+|    Probe the binary implication graph at the root level. Its strongly connected components are
+|    classes of equivalent literals, which are substituted first (see 'substituteEquivs()'). Then
+|    each root of the graph, a literal that is implied by no other, is assigned in both polarities:
+|    a failed polarity gives its negation as a unit, and so does a literal implied by both. The
+|    pass may spend 'probe_effort' times the propagations made by search since the previous pass,
+|    plus one per variable in the first pass so that it gets to run. Each pass goes on from the
+|    literal where the previous one stopped, wrapping around.
+|________________________________________________________________________________________________@*/
+bool Solver::probe() {
+  assert(decisionLevel() == 0);
+  if (!ok || propagate() != CRef_Undef)
+    return ok = false;
+
+  if (use_equiv && !substituteEquivs())
+    return ok = false;
+
+  vec<int> start;
+  vec<Lit> edges;
+  buildBinaryGraph(start, edges);
+
+  vec<char> implied(2 * nVars(), 0);
+  for (int i = 0; i < edges.size(); i++)
+    implied[toInt(edges[i])] = 1;
+
+  uint64_t limit = propagations + (propagations - probe_props) * probe_effort +
+      (probe_props == 0 ? nVars() : 0);
+  int n = 2 * nVars();
+  if (probe_next >= n)
+    probe_next = 0;
+  for (int k = 0; k < n && propagations < limit; k++, probe_next = (probe_next + 1) % n) {
+    int i = probe_next;
+    Lit p = toLit(i);
+    if (implied[i] || start[i] == start[i + 1] || value(p) != l_Undef)
+      continue;
+    probed_lits++;
+    if (!probeLit(p))
+      return ok = false;
+  }
+
+  probe_props = propagations;
+  return true;
+}
+
+bool Solver::probeLit(Lit p) {
+  vec<Lit> units, marked;
+
+  // Mark what 'p' implies by the polarity it is implied in:
+  newDecisionLevel();
+  uncheckedEnqueue(p);
+  bool failed = propagate() != CRef_Undef;
+  for (int i = trail_lim[0] + 1; !failed && i < trail.size(); i++) {
+    seen[var(trail[i])] = 1 + sign(trail[i]);
+    marked.push(trail[i]);
+  }
+  cancelUntil(0, false);
+
+  if (!failed) {
+    newDecisionLevel();
+    uncheckedEnqueue(~p);
+    failed = propagate() != CRef_Undef;
+    for (int i = trail_lim[0] + 1; !failed && i < trail.size(); i++) {
+      if (seen[var(trail[i])] == 1 + sign(trail[i]))
+        units.push(trail[i]);
+    }
+    cancelUntil(0, false);
+    for (int i = 0; i < marked.size(); i++)
+      seen[var(marked[i])] = 0;
+    if (failed)
+      p = ~p;
+  }
+
+  if (failed) {
+    failed_lits++;
+    uncheckedEnqueue(~p);
+  } else {
+    implied_lits += units.size();
+    for (int i = 0; i < units.size(); i++)
+      uncheckedEnqueue(units[i]);
+  }
+  return propagate() == CRef_Undef;
+}
+
+void Solver::buildBinaryGraph(vec<int>& start, vec<Lit>& edges) {
+  // (Variables of cardinality and XOR constraints are left out, since the constraints are not
+  // rewritten when equivalent literals are substituted.)
+  start.clear();
+  start.growTo(2 * nVars() + 1, 0);
+  for (int k = 0; k < 2; k++) {
+    const vec<CRef>& cs = k == 0 ? clauses : learnts;
+    for (int i = 0; i < cs.size(); i++) {
+      const Clause& c = ca[cs[i]];
+      if (c.size() != 2 || value(c[0]) != l_Undef || value(c[1]) != l_Undef ||
+          !decision[var(c[0])] || !decision[var(c[1])] ||
+          inConstraint(var(c[0])) || inConstraint(var(c[1])))
+        continue;
+      start[toInt(~c[0]) + 1]++;
+      start[toInt(~c[1]) + 1]++;
+    }
+  }
+  for (int i = 0; i < 2 * nVars(); i++)
+    start[i + 1] += start[i];
+
+  vec<int> pos;
+  start.copyTo(pos);
+  edges.clear();
+  edges.growTo(start.last());
+  for (int k = 0; k < 2; k++) {
+    const vec<CRef>& cs = k == 0 ? clauses : learnts;
+    for (int i = 0; i < cs.size(); i++) {
+      const Clause& c = ca[cs[i]];
+      if (c.size() != 2 || value(c[0]) != l_Undef || value(c[1]) != l_Undef ||
+          !decision[var(c[0])] || !decision[var(c[1])] ||
+          inConstraint(var(c[0])) || inConstraint(var(c[1])))
+        continue;
+      edges[pos[toInt(~c[0])]++] = c[1];
+      edges[pos[toInt(~c[1])]++] = c[0];
+    }
+  }
+}
+
+// Finds the strongly connected components of the binary implication graph with Tarjan's
+// algorithm. Each component except one of a pair of mirrored ones is mapped to the literal of its
+// smallest variable in 'equiv', and the substituted variables are removed from all clauses.
+bool Solver::substituteEquivs() {
+  vec<int> start;
+  vec<Lit> edges;
+  buildBinaryGraph(start, edges);
+
+  int n = 2 * nVars();
+  vec<int> index(n, -1);
+  vec<int> low(n, 0);
+  vec<char> on_stack(n, 0);
+  vec<int> stack;
+  vec<int> path;
+  vec<int> next;
+  vec<Var> substituted;
+  int counter = 0;
+
+  for (int r = 0; r < n; r++) {
+    if (index[r] >= 0 || start[r] == start[r + 1])
+      continue;
+
+    index[r] = low[r] = counter++;
+    stack.push(r);
+    on_stack[r] = 1;
+    path.push(r);
+    next.push(start[r]);
+    while (path.size() > 0) {
+      int x = path.last();
+      if (next.last() < start[x + 1]) {
+        int y = toInt(edges[next.last()++]);
+        if (index[y] < 0) {
+          index[y] = low[y] = counter++;
+          stack.push(y);
+          on_stack[y] = 1;
+          path.push(y);
+          next.push(start[y]);
+        } else if (on_stack[y] && index[y] < low[x]) {
+          low[x] = index[y];
+        }
+        continue;
+      }
+
+      path.pop();
+      next.pop();
+      if (path.size() > 0 && low[x] < low[path.last()])
+        low[path.last()] = low[x];
+      if (low[x] != index[x])
+        continue;
+
+      // 'x' is the root of a component; pop it off the stack:
+      int first = stack.size() - 1;
+      while (stack[first] != x)
+        first--;
+      Lit rep = toLit(x);
+      for (int i = first; i < stack.size(); i++) {
+        Lit q = toLit(stack[i]);
+        on_stack[stack[i]] = 0;
+        if (var(q) < var(rep))
+          rep = q;
+        if (seen[var(q)]) {
+          // Both 'q' and '~q' are in the component:
+          for (int j = first; j < i; j++)
+            seen[var(toLit(stack[j]))] = 0;
+          return ok = false;
+        }
+        seen[var(q)] = 1;
+      }
+      for (int i = first; i < stack.size(); i++) {
+        Lit q = toLit(stack[i]);
+        seen[var(q)] = 0;
+        if (var(q) != var(rep) && equiv[var(q)] == lit_Undef) {
+          equiv[var(q)] = rep ^ sign(q);
+          substituted.push(var(q));
+        }
+      }
+      stack.shrink(stack.size() - first);
+    }
+  }
+
+  if (substituted.size() == 0)
+    return true;
+
+  // The substituted variables take the value of their representatives in the model:
+  for (int i = 0; i < substituted.size(); i++) {
+    Var v = substituted[i];
+    Lit x = mkLit(v);
+    Lit l = equiv[v];
+    elimclauses.push(toInt(x));
+    elimclauses.push(toInt(~l));
+    elimclauses.push(2);
+    elimclauses.push(toInt(~x));
+    elimclauses.push(toInt(l));
+    elimclauses.push(2);
+    elimclauses.push(toInt(x));
+    elimclauses.push(1);
+    setDecisionVar(v, false);
+  }
+  equiv_lits += substituted.size();
+
+  vec<Lit> units;
+  if (!substituteClauses(clauses, units) || !substituteClauses(learnts, units))
+    return ok = false;
+
+  // Watches are rebuilt from scratch, since the rewritten clauses are no longer watched
+  // by their first two literals:
+  for (Var v = 0; v < nVars(); v++) {
+    watches[ mkLit(v)].clear();
+    watches[~mkLit(v)].clear();
+  }
+  num_clauses = num_learnts = clauses_literals = learnts_literals = 0;
+  for (int i = 0; i < clauses.size(); i++)
+    attachClause(clauses[i]);
+  for (int i = 0; i < learnts.size(); i++)
+    attachClause(learnts[i]);
+
+  for (int i = 0; i < units.size(); i++) {
+    if (!enqueue(units[i]))
+      return ok = false;
+  }
+  return ok = propagate() == CRef_Undef;
+}
+
+bool Solver::substituteClauses(vec<CRef>& cs, vec<Lit>& units) {
+  svec<Lit, 16> lits;
+  int i, j;
+  for (i = j = 0; i < cs.size(); i++) {
+    Clause& c = ca[cs[i]];
+    int k = 0;
+    while (k < c.size() && equiv[var(c[k])] == lit_Undef)
+      k++;
+    if (k == c.size()) {
+      cs[j++] = cs[i];
+      continue;
+    }
+
+    lits.clear();
+    for (k = 0; k < c.size(); k++)
+      lits.push(repr(c[k]));
+    sort(lits);
+    bool sat = false;
+    Lit p; int a, b;
+    for (a = b = 0, p = lit_Undef; a < lits.size() && !sat; a++) {
+      sat = value(lits[a]) == l_True || lits[a] == ~p;
+      if (value(lits[a]) != l_False && lits[a] != p)
+        lits[b++] = p = lits[a];
+    }
+    lits.shrink(a - b);
+
+    if (sat || lits.size() < 2) {
+      removeClause(cs[i]);
+      if (sat)
+        continue;
+      if (lits.size() == 0)
+        return false;
+      units.push(lits[0]);
+      continue;
+    }
+
+    for (k = 0; k < lits.size(); k++)
+      c[k] = lits[k];
+    c.shrink(c.size() - lits.size());
+    if (!c.learnt() && c.has_extra())
+      c.calcAbstraction();
+    cs[j++] = cs[i];
+  }
+  cs.shrink(i - j);
+  return true;
+}
+
 /*_________________________________________________________________________________________________
 |
 |  search : (nof_conflicts : int) (params : const SearchParams&)  ->  [lbool]
@@ -722,7 +2040,7 @@ lbool Solver::search(int nof_conflicts, const vec<Lit>& assumptions)
   assert(ok);
   int         backtrack_level;
   int         conflictC = 0;
-  vec<Lit>    learnt_clause;
+  svec<Lit, 64> learnt_clause;
   starts++;
 
   for (;;){
@@ -730,8 +2048,10 @@ lbool Solver::search(int nof_conflicts, const vec<Lit>& assumptions)
     if (confl != CRef_Undef){
       // CONFLICT
       conflicts++; conflictC++;
+      publishStats();
       if (decisionLevel() == 0) return l_False;
-      
+      updateTargetPhases(trail_lim.last());
+
       learnt_clause.clear();
       analyze(confl, learnt_clause, backtrack_level);
       cancelUntil(backtrack_level);
@@ -759,7 +2079,8 @@ lbool Solver::search(int nof_conflicts, const vec<Lit>& assumptions)
       if ((nof_conflicts >= 0 && conflictC >= nof_conflicts) || !withinBudget()){
         // Reached bound on number of conflicts:
         progress_estimate = progressEstimate();
-        cancelUntil(0);
+        updateTargetPhases(trail.size());
+        cancelUntil(reuse_trail ? reuseTrailLevel(assumptions) : 0);
         return l_Undef;
       }
 
@@ -845,11 +2166,21 @@ static double luby(double y, int x) {
   return pow(y, seq);
 }
 
-// NOTE: assumptions passed in member-variable 'assumptions'.
-lbool Solver::solveLimited(const vec<Lit>& assumptions) {
+// NOTE: assumptions on substituted variables are replaced by their representatives, and
+// 'conflict' is expressed in those.
+lbool Solver::solveLimited(const vec<Lit>& assumps) {
+  PROFILE_PHASE(Phase_Solve);
   model.clear();
   conflict.clear();
   if (!ok) return l_False;
+  if (xors_changed && !buildXorMatrix()) {
+    ok = false;
+    return l_False;
+  }
+
+  vec<Lit> assumptions;
+  for (int i = 0; i < assumps.size(); i++)
+    assumptions.push(repr(assumps[i]));
 
   solves++;
 
@@ -868,6 +2199,18 @@ lbool Solver::solveLimited(const vec<Lit>& assumptions) {
     status = search(rest_base * restart_first, assumptions);
     if (!withinBudget()) break;
     curr_restarts++;
+    if (status == l_Undef) {
+      restarts++;
+      if (verbosity >= 1)
+        printProgress();
+    }
+    target_assigned = 0;
+
+    if (status == l_Undef && rephase_first > 0 && conflicts >= next_rephase)
+      rephase();
+
+    if (status == l_Undef && vivify_effort > 0 && !vivify())
+      status = l_False;
   }
 
   if (status == l_True) {
@@ -875,18 +2218,37 @@ lbool Solver::solveLimited(const vec<Lit>& assumptions) {
     model.growTo(nVars());
     for (int i = 0; i < nVars(); i++)
       model[i] = value(i);
+    if (extend_model)
+      extendModel();
   } else if (status == l_False && conflict.size() == 0) {
     ok = false;
   }
 
   cancelUntil(0);
+  publishStats();
   return status;
 }
 
+void Solver::extendModel() {
+  int i, j;
+  Lit x;
+
+  for (i = elimclauses.size()-1; i > 0; i -= j) {
+    for (j = elimclauses[i--]; j > 1; j--, i--) {
+      if (modelValue(toLit(elimclauses[i])) != l_False)
+        goto next;
+    }
+
+    x = toLit(elimclauses[i]);
+    model[var(x)] = lbool::fromBool(!sign(x));
+  next:;
+  }
+}
+
 bool Solver::implies(const vec<Lit>& assumps, vec<Lit>& out) {
   trail_lim.push(trail.size());
   for (int i = 0; i < assumps.size(); i++) {
-    Lit a = assumps[i];
+    Lit a = repr(assumps[i]);
 
     if (value(a) == l_False) {
       cancelUntil(0);
@@ -910,19 +2272,327 @@ bool Solver::implies(const vec<Lit>& assumps, vec<Lit>& out) {
   return ret;
 }
 
+/*_________________________________________________________________________________________________
+|
+|  generateCubes : (max_cubes : int) (out_cubes : vec<vec<Lit>>&)  ->  [bool]
+|  
+|  Description:
+|    Split the search space for cube-and-conquer. Starting from the empty cube, the cube with the
+|    fewest assigned variables is split on the candidate whose two polarities imply the most
+|    literals together (by their product), until there are 'max_cubes' cubes or none is left to
+|    split. Lookahead also finds failed literals, which are added to the cube (or learnt as units
+|    at the root), and drops the cubes in which a candidate fails both ways.
+|________________________________________________________________________________________________@*/
+bool Solver::generateCubes(int max_cubes, vec<vec<Lit>>& out_cubes) {
+  out_cubes.clear();
+  if (!ok || (xors_changed && !buildXorMatrix()) || !simplify())
+    return ok = false;
+
+  // The candidates are preselected by their occurrences in both polarities, shorter constraints
+  // counting more:
+  vec<double> occ(2 * nVars(), 0);
+  for (int i = 0; i < clauses.size(); i++) {
+    const Clause& c = ca[clauses[i]];
+    for (int j = 0; j < c.size(); j++)
+      occ[toInt(c[j])] += 1.0 / c.size();
+  }
+  for (int i = 0; i < cards.size(); i++) {
+    const vec<Lit>& lits = cards[i].lits;
+    for (int j = 0; j < lits.size(); j++)
+      occ[toInt(lits[j])] += 1.0 / lits.size();
+  }
+  for (int i = 0; i < xors.size(); i++) {
+    const vec<Var>& vars = xors[i].vars;
+    for (int j = 0; j < vars.size(); j++) {
+      occ[toInt(mkLit(vars[j], false))] += 1.0 / vars.size();
+      occ[toInt(mkLit(vars[j], true))] += 1.0 / vars.size();
+    }
+  }
+  VMap<double> score;
+  vec<Var> order;
+  for (Var v = 0; v < nVars(); v++) {
+    score.insert(v, (occ[toInt(mkLit(v, false))] + 1) * (occ[toInt(mkLit(v, true))] + 1), 0);
+    if (decision[v] && value(v) == l_Undef)
+      order.push(v);
+  }
+  sort(order, VarOrderLt(score));
+
+  vec<vec<Lit>> open;
+  vec<int> assigned;
+  open.push();
+  assigned.push(0);
+  while (open.size() > 0 && out_cubes.size() + open.size() < max_cubes) {
+    int best = 0;
+    for (int i = 1; i < open.size(); i++) {
+      if (assigned[i] < assigned[best])
+        best = i;
+    }
+    vec<Lit> cube;
+    open[best].moveTo(cube);
+    if (best != open.size() - 1) {
+      open.last().moveTo(open[best]);
+      assigned[best] = assigned.last();
+    }
+    open.pop();
+    assigned.pop();
+
+    Var split;
+    int pos, neg;
+    bool refuted = !lookaheadCube(cube, order, split, pos, neg);
+    cancelUntil(0, false);
+    if (!ok)
+      break;
+    if (refuted)
+      continue;
+
+    if (split == var_Undef) {
+      out_cubes.push();
+      cube.moveTo(out_cubes.last());
+      continue;
+    }
+    open.push();
+    cube.copyTo(open.last());
+    open.last().push(mkLit(split, false));
+    assigned.push(pos);
+    open.push();
+    cube.moveTo(open.last());
+    open.last().push(mkLit(split, true));
+    assigned.push(neg);
+  }
+
+  for (int i = 0; ok && i < open.size(); i++) {
+    out_cubes.push();
+    open[i].moveTo(out_cubes.last());
+  }
+  if (out_cubes.size() == 0)
+    ok = false;
+  return ok;
+}
+
+bool Solver::lookaheadCube(vec<Lit>& cube, const vec<Var>& order, Var& out_split,
+                           int& out_pos, int& out_neg) {
+  for (int i = 0; i < cube.size(); i++) {
+    if (value(cube[i]) == l_False)
+      return false;
+    if (value(cube[i]) == l_Undef) {
+      newDecisionLevel();
+      uncheckedEnqueue(cube[i]);
+      if (propagate() != CRef_Undef)
+        return false;
+    }
+  }
+
+  // Look ahead again after failed literals, since they change what the others imply:
+  bool failed;
+  do {
+    failed = false;
+    out_split = var_Undef;
+    double best = -1;
+    for (int i = 0, n = 0; i < order.size() && n < cube_candidates; i++) {
+      Var v = order[i];
+      if (value(v) != l_Undef)
+        continue;
+      n++;
+      int pos = lookahead(mkLit(v, false));
+      int neg = lookahead(mkLit(v, true));
+      if (pos < 0 && neg < 0) {
+        if (decisionLevel() == 0)
+          ok = false;
+        return false;
+      }
+      if (pos < 0 || neg < 0) {
+        // The other polarity is implied by the cube:
+        Lit p = mkLit(v, pos < 0);
+        failed = true;
+        if (decisionLevel() == 0) {
+          failed_lits++;
+        } else {
+          cube.push(p);
+          newDecisionLevel();
+        }
+        uncheckedEnqueue(p);
+        if (propagate() != CRef_Undef) {
+          if (decisionLevel() == 0)
+            ok = false;
+          return false;
+        }
+        continue;
+      }
+      if ((double)pos * neg > best) {
+        best = (double)pos * neg;
+        out_split = v;
+        out_pos = pos;
+        out_neg = neg;
+      }
+    }
+  } while (failed);
+
+  int base = decisionLevel() > 0 ? trail.size() - trail_lim[0] : 0;
+  out_pos += base;
+  out_neg += base;
+  return true;
+}
+
+int Solver::lookahead(Lit p) {
+  newDecisionLevel();
+  uncheckedEnqueue(p);
+  int implied = propagate() == CRef_Undef ? trail.size() - trail_lim.last() : -1;
+  cancelUntil(decisionLevel() - 1, false);
+  return implied;
+}
+
+void Solver::publishStats() {
+  stats.version = stats_version;
+  stats.size = sizeof(Stats);
+  stats.solves = solves;
+  stats.starts = starts;
+  stats.restarts = restarts;
+  stats.decisions = decisions;
+  stats.rnd_decisions = rnd_decisions;
+  stats.propagations = propagations;
+  stats.conflicts = conflicts;
+  stats.vars = nVars();
+  stats.dec_vars = dec_vars;
+  stats.num_clauses = num_clauses;
+  stats.num_learnts = num_learnts;
+  stats.clauses_literals = clauses_literals;
+  stats.learnts_literals = learnts_literals;
+  stats.max_literals = max_literals;
+  stats.tot_literals = tot_literals;
+  stats.reduce_dbs = reduce_dbs;
+  stats.garbage_collections = garbage_collections;
+  stats.arena_bytes = (uint64_t)ca.size() * ClauseAllocator::Unit_Size;
+  stats.arena_wasted_bytes = (uint64_t)ca.wasted() * ClauseAllocator::Unit_Size;
+}
+
+void Solver::memoryUsage(MemoryUsage& out) const {
+  const uint64_t unit = ClauseAllocator::Unit_Size;
+  uint64_t used = ((uint64_t)ca.size() - ca.wasted()) * unit;
+  out.clauses = num_clauses * sizeof(Clause) +
+      (clauses_literals + (ca.extra_clause_field ? num_clauses : 0)) * sizeof(Lit);
+  out.learnts = num_learnts * (sizeof(Clause) + sizeof(Lit)) + learnts_literals * sizeof(Lit);
+  out.arena_other = used > out.clauses + out.learnts ? used - out.clauses - out.learnts : 0;
+  out.arena_wasted = (uint64_t)ca.wasted() * unit;
+  out.arena_free = ca.memoryUsage() - (uint64_t)ca.size() * unit;
+
+  out.clause_lists = clauses.memoryUsage() + learnts.memoryUsage() + explanations.memoryUsage();
+  out.watches = watches.memoryUsage();
+
+  out.variables = activity.memoryUsage() + user_pol.memoryUsage() + target_pol.memoryUsage() +
+      best_pol.memoryUsage() + decision.memoryUsage() + equiv.memoryUsage() +
+      lazy_reason.memoryUsage() + xor_col.memoryUsage() + order_heap.memoryUsage();
+#if defined(MINISAT_PACKED_VARS)
+  out.variables += var_state.memoryUsage();
+#else
+  out.variables += assigns.memoryUsage() + polarity.memoryUsage() + vardata.memoryUsage() +
+      seen.memoryUsage();
+#endif
+
+  out.trail = trail.memoryUsage() + trail_lim.memoryUsage();
+
+  out.constraints = cards.memoryUsage() + card_occs.memoryUsage() + xors.memoryUsage() +
+      xor_vars.memoryUsage() + xor_matrix.bits.memoryUsage() + xor_watches.memoryUsage() +
+      xor_reason_rows.memoryUsage();
+  for (int i = 0; i < cards.size(); i++)
+    out.constraints += cards[i].lits.memoryUsage() + cards[i].counted.memoryUsage();
+  for (int i = 0; i < xors.size(); i++)
+    out.constraints += xors[i].vars.memoryUsage();
+
+  out.total = ca.memoryUsage() + out.clause_lists + out.watches + out.variables + out.trail +
+      out.constraints;
+}
+
+static void appendText(vec<char>& out, const char* text) {
+  while (*text)
+    out.push(*text++);
+}
+
+static void appendNumber(vec<char>& out, uint64_t x) {
+  char digits[20];
+  int n = 0;
+  do {
+    digits[n++] = '0' + x % 10;
+    x /= 10;
+  } while (x > 0);
+  while (n > 0)
+    out.push(digits[--n]);
+}
+
+void Solver::printProgress() const {
+  MemoryUsage mem;
+  memoryUsage(mem);
+
+  vec<char> line;
+  appendText(line, "c restarts ");
+  appendNumber(line, restarts);
+  appendText(line, " conflicts ");
+  appendNumber(line, conflicts);
+  appendText(line, " learnts ");
+  appendNumber(line, num_learnts);
+  appendText(line, " | KB clauses ");
+  appendNumber(line, mem.clauses >> 10);
+  appendText(line, " learnts ");
+  appendNumber(line, mem.learnts >> 10);
+  appendText(line, " wasted ");
+  appendNumber(line, mem.arena_wasted >> 10);
+  appendText(line, " watches ");
+  appendNumber(line, mem.watches >> 10);
+  appendText(line, " vars ");
+  appendNumber(line, mem.variables >> 10);
+  appendText(line, " total ");
+  appendNumber(line, mem.total >> 10);
+  print(line, line.size());
+}
+
 //=================================================================================================
 // Garbage Collection methods:
 void Solver::relocAll(ClauseAllocator& to) {
-  // All watchers:
+  // All watchers, in the order propagation is going to visit them: the assigned variables in
+  // trail order, then the unassigned ones by activity. The watches of the literals that are (or
+  // will be) true come first. Original clauses are placed before learnt ones. (When compacting in
+  // place, the clauses keep their address order and only the references are updated.)
   //
   watches.cleanAll();
-  for (int v = 0; v < nVars(); v++)
+  // Also give back the blocks that watch lists have outgrown:
+  watches.compact();
+  if (&to != &ca) {
+    vec<Var> vs;
+    for (int i = 0; i < trail.size(); i++)
+      vs.push(var(trail[i]));
+    int assigned = vs.size();
+    for (Var v = 0; v < nVars(); v++) {
+      if (value(v) == l_Undef)
+        vs.push(v);
+    }
+    sort((Var*)vs + assigned, vs.size() - assigned, VarOrderLt(activity));
+
+    for (int learnt = 0; learnt < 2; learnt++) {
+      for (int cold = 0; cold < 2; cold++) {
+        for (int i = 0; i < vs.size(); i++) {
+          Var v = vs[i];
+          bool s = value(v) != l_Undef ? value(v) == l_False
+              : use_target ? target_pol[v] : polarity[v];
+          const WatchList ws = watches[mkLit(v, s != (bool)cold)];
+          for (int j = 0; j < ws.size(); j++) {
+            // The watchers themselves are updated below; until then they refer to 'ca':
+            CRef cr = ws[j].cref();
+            if (ca[cr].learnt() == (bool)learnt)
+              ca.reloc(cr, to);
+          }
+        }
+      }
+    }
+  }
+  for (int v = 0; v < nVars(); v++) {
     for (int s = 0; s < 2; s++) {
-      Lit p = mkLit(v, s);
-      vec<Watcher>& ws = watches[p];
-      for (int j = 0; j < ws.size(); j++)
-        ca.reloc(ws[j].cref, to);
+      WatchList ws = watches[mkLit(v, s)];
+      for (int j = 0; j < ws.size(); j++) {
+        CRef cr = ws[j].cref();
+        ca.reloc(cr, to);
+        ws[j] = Watcher(cr, ws[j].blocker, ws[j].binary());
+      }
     }
+  }
 
   // All reasons:
   //
@@ -931,12 +2601,18 @@ void Solver::relocAll(ClauseAllocator& to) {
 
     // Note: it is not safe to call 'locked()' on a relocated clause. This is why we keep
     // 'dangling' reasons here. It is safe and does not hurt.
-    if (reason(v) != CRef_Undef && (ca[reason(v)].reloced() || locked(ca[reason(v)]))) {
+    if (reason(v) != CRef_Undef && reason(v) != CRef_Lazy &&
+        (ca[reason(v)].reloced() || locked(ca[reason(v)]))) {
       assert(!isRemoved(reason(v)));
       ca.reloc(vardata[v].reason, to);
     }
   }
 
+  // All explanations (the ones left by 'sweepExplanations()' are reasons):
+  //
+  for (int i = 0; i < explanations.size(); i++)
+    ca.reloc(explanations[i], to);
+
   // All learnt:
   //
   int i, j;
@@ -960,6 +2636,17 @@ void Solver::relocAll(ClauseAllocator& to) {
 }
 
 void Solver::garbageCollect() {
+  PROFILE_PHASE(Phase_GarbageCollect);
+  garbage_collections++;
+  sweepExplanations();
+  if (inPlaceGC()) {
+    vec<Lit> displaced;
+    ca.forwardAll(displaced);
+    relocAll(ca);
+    ca.slideAll(displaced);
+    return;
+  }
+
   // Initialize the next region to a size corresponding to the estimated utilization degree. This
   // is not precise but should avoid some unnecessary reallocations for the new region:
   ClauseAllocator to(ca.size() - ca.wasted()); 
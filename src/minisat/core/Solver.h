@@ -26,16 +26,17 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "minisat/mtl/Alg.h"
 #include "minisat/mtl/IntMap.h"
 #include "minisat/core/SolverTypes.h"
+#include "minisat/core/Profile.h"
 
 namespace Minisat {
 
 //=================================================================================================
 // Solver -- the main class:
 
-class Solver final {
+class Solver {
 public:
   Solver();
-  ~Solver();
+  virtual ~Solver();
 
   // Problem specification:
   //
@@ -47,10 +48,22 @@ public:
 
   // Add a clause to the solver.
   bool addClause(vec<Lit> ps);
+  // Add a clause to the solver without making a copy. Note that 'ps' may be
+  // modified.
+  bool addClause_(vec<Lit>& ps);
+  // Add the constraint that at most 'k' of the literals 'ps' are true, where
+  // a literal that occurs more than once counts as often. Note that 'ps' may
+  // be modified.
+  bool addAtMostK_(vec<Lit>& ps, int k);
+  // Add the constraint that the literals 'ps' have the parity 'rhs' (that is,
+  // an odd number of them is true if 'rhs' is set). Note that 'ps' may be
+  // modified.
+  bool addXor_(vec<Lit>& ps, bool rhs);
 
   // Solving:
   //
-  // Removes already satisfied clauses.
+  // Removes already satisfied clauses, and probes the binary implication graph
+  // for failed and equivalent literals.
   bool simplify();
 
   // Search for a model that respects a given set of assumptions.
@@ -59,6 +72,17 @@ public:
   // Search for a model that respects a given set of assumptions (With resource constraints).
   lbool solveLimited(const vec<Lit>& assumptions);
 
+  // Split the search space by lookahead into at most 'max_cubes' cubes, each
+  // a set of assumptions for 'solve()'. Every model satisfies one of the cubes;
+  // those refuted while splitting are left out. Returns false if the problem
+  // is found unsatisfiable, in which case 'out_cubes' is empty.
+  bool generateCubes(int max_cubes, vec<vec<Lit>>& out_cubes);
+
+  // Run ProbSAT local search on the problem clauses for up to 'flips' flips,
+  // starting from the saved phases, and save the best assignment found as the
+  // phases. Returns l_True, with the model, if it satisfies the problem.
+  lbool localSearch(int64_t flips);
+
   // FALSE means solver is in a conflicting state
   bool okay() const;
   bool implies(const vec<Lit>& assumps, vec<Lit>& out);
@@ -90,6 +114,8 @@ public:
   // The value of a literal in the last model. The last call to solve must have
   // been satisfiable.
   lbool modelValue(Lit p) const;
+  // The literal that stands for 'p' after equivalent-literal substitution.
+  Lit repr(Lit p) const;
 
   // The current number of assigned literals.
   int nAssigns() const;
@@ -114,7 +140,7 @@ public:
 
   // Memory managment:
   //
-  void garbageCollect();
+  virtual void garbageCollect();
   void checkGarbage(double gf);
   void checkGarbage();
 
@@ -128,19 +154,35 @@ public:
 
   // Mode of operation:
   //
-  const int verbosity;
+  // 0 is silent, and 1 prints the progress and memory usage after each
+  // restart.
+  int verbosity;
   const double var_decay;
   const double clause_decay;
   const double random_var_freq;
   double random_seed;
   bool luby_restart;
 
-  // Controls conflict clause minimization (0=none, 1=basic, 2=deep).
+  // Controls conflict clause minimization (0=none, 1=basic, 2=deep, 3=deep and
+  // binary implications of the asserting literal, 4=as 3 and shrinking of
+  // each decision level to its unique implication point).
   const int ccmin_mode;
 
   // Controls the level of phase saving (0=none, 1=limited, 2=full).
   const int phase_saving;
 
+  // Branch on the target phase, the assignment of the largest conflict-free
+  // trail since the last restart, instead of the saved phase.
+  const bool use_target;
+
+  // The number of conflicts before the first rephasing; the interval grows by
+  // this much after each one. 0 disables rephasing. (default 1000)
+  const int rephase_first;
+
+  // The flips that local search may make when rephasing, as a fraction of the
+  // search propagations since it last ran. (default 0.1)
+  const double walk_effort;
+
   // Use random polarities for branching heuristics.
   const bool rnd_pol;
 
@@ -154,6 +196,17 @@ public:
   // Minimum number to set the learnts limit to.
   const int min_learnts_lim;
 
+  // The number of conflicts after which 'reduceDB' collects garbage even if
+  // 'garbage_frac' is not reached, to restore the clause layout. 0 disables.
+  // (default 0)
+  const int compact_interval;
+
+  // The clause arena size (in MB) from which garbage collection slides the
+  // clauses down in place instead of copying them into a new arena, which
+  // needs no second arena but loses the propagation-order layout. 0 always
+  // compacts in place, -1 never does. (default 256)
+  const int inplace_gc_lim;
+
   // The initial restart limit. (default 100)
   const int restart_first;
 
@@ -161,6 +214,32 @@ public:
   // (default 1.5)
   const double restart_inc;
 
+  // On restart, keep the decision levels whose decisions are more active
+  // than the next decision would be.
+  const bool reuse_trail;
+
+  // The fraction of search propagations that may be spent on vivifying clauses
+  // between restarts. 0 disables vivification. (default 0.1)
+  const double vivify_effort;
+
+  // Vivify original clauses too, not only learnt ones.
+  const bool vivify_irred;
+
+  // The fraction of search propagations that may be spent on probing the
+  // roots of the binary implication graph in 'simplify'. 0 disables probing.
+  // (default 0.05)
+  const double probe_effort;
+
+  // Substitute equivalent literals found in the binary implication graph.
+  const bool use_equiv;
+
+  // The number of variables that 'generateCubes' looks ahead on to split each
+  // cube, taken by their occurrences in the constraints. (default 64)
+  const int cube_candidates;
+
+  // Flag to indicate whether the user needs to look at the full model.
+  bool extend_model;
+
   // The intitial limit for learnt clauses is a factor of the original clauses.
   // (default 1 / 3)
   double learntsize_factor;
@@ -177,6 +256,51 @@ public:
   uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts;
   uint64_t dec_vars, num_clauses, num_learnts, clauses_literals,
     learnts_literals, max_literals, tot_literals;
+  uint64_t vivified_clauses, vivified_lits;
+  uint64_t probed_lits, failed_lits, implied_lits, equiv_lits;
+  uint64_t rephases, walks, walk_flips;
+  uint64_t restarts, reduce_dbs, garbage_collections;
+
+  // The statistics in a fixed layout for readers that share the memory with
+  // the solver, such as a monitoring worker, and may look at any time.
+  // 'search()' refreshes it at every conflict. 'version' changes whenever the
+  // layout does, and 'size' is its size in bytes.
+  struct Stats {
+    uint32_t version;
+    uint32_t size;
+    uint64_t solves, starts, restarts, decisions, rnd_decisions, propagations, conflicts;
+    uint64_t vars, dec_vars, num_clauses, num_learnts, clauses_literals, learnts_literals;
+    uint64_t max_literals, tot_literals;
+    uint64_t reduce_dbs, garbage_collections, arena_bytes, arena_wasted_bytes;
+  };
+  static constexpr uint32_t stats_version = 1;
+  Stats stats = {stats_version, sizeof(Stats)};
+
+  // The bytes that the data structures of the solver take, including the
+  // capacity they have reserved but not used yet.
+  struct MemoryUsage {
+    // The clause arena: the original and learnt clauses (estimated from their
+    // literal counts), the rest in use (such as explanations), the space of
+    // deleted clauses until the next garbage collection, and the reserve.
+    uint64_t clauses, learnts, arena_other, arena_wasted, arena_free;
+    // The lists of clause references, and the watch lists.
+    uint64_t clause_lists, watches;
+    // The per-variable maps and the variable order heap.
+    uint64_t variables;
+    // The trail and its decision level separators.
+    uint64_t trail;
+    // Cardinality and XOR constraints.
+    uint64_t constraints;
+    uint64_t total;
+  };
+  // Fill in 'out' from the capacities of the data structures, cheaply enough
+  // to run at every restart.
+  void memoryUsage(MemoryUsage& out) const;
+
+#if defined(MINISAT_PROFILING)
+  // The time spent in each phase of the search (see 'PROFILE_PHASE').
+  Profile profile;
+#endif
 
  protected:
   // Helper structures:
@@ -187,19 +311,44 @@ public:
     return d;
   }
 
+#if defined(MINISAT_PACKED_VARS)
+  // The per-variable fields that assigning, backtracking and conflict analysis
+  // read together, in one record. 'VarField' indexes one of them like a 'VMap'.
+  struct VarState { VarData data; lbool value; char polarity; char seen; };
+
+  template<class F, F VarState::*field>
+  class VarField {
+    VMap<VarState>& states;
+   public:
+    explicit VarField(VMap<VarState>& s) : states(s) {}
+    F& operator[](Var x) { return states[x].*field; }
+    const F& operator[](Var x) const { return states[x].*field; }
+  };
+  typedef VarField<VarData, &VarState::data> VarDataMap;
+#else
+  typedef VMap<VarData> VarDataMap;
+#endif
+
+  // The watchers of a binary clause have 'CRef_Binary' set in 'tagged'. Such a clause is
+  // propagated from the watcher alone, with 'blocker' as its other literal, so the watcher stays
+  // two words and the clause is only visited when it becomes a reason.
   struct Watcher {
-    CRef cref;
+    CRef tagged;
     Lit  blocker;
-    Watcher(CRef cr, Lit p) : cref(cr), blocker(p) {}
-    bool operator==(const Watcher& w) const { return cref == w.cref; }
-    bool operator!=(const Watcher& w) const { return cref != w.cref; }
+    Watcher(CRef cr, Lit p, bool binary) : tagged(binary ? cr | CRef_Binary : cr), blocker(p) {}
+    CRef cref() const { return tagged & ~CRef_Binary; }
+    bool binary() const { return (tagged & CRef_Binary) != 0; }
+    bool operator==(const Watcher& w) const { return tagged == w.tagged; }
+    bool operator!=(const Watcher& w) const { return tagged != w.tagged; }
   };
 
   struct WatcherDeleted {
     const ClauseAllocator& ca;
     WatcherDeleted(const ClauseAllocator& _ca) : ca(_ca) {}
-    bool operator()(const Watcher& w) const { return ca[w.cref].mark() == 1; }
+    bool operator()(const Watcher& w) const { return ca[w.cref()].mark() == 1; }
   };
+  typedef OccPool<Lit, Watcher, WatcherDeleted, MkIndexLit, CRef> WatchLists;
+  typedef WatchLists::List WatchList;
 
   struct VarOrderLt {
     const IntMap<Var, double>&  activity;
@@ -207,18 +356,92 @@ public:
     VarOrderLt(const IntMap<Var, double>&  act) : activity(act) {}
   };
 
+  // Priority of a variable in 'order_heap', which caches it:
+  struct VarOrderPrio {
+    typedef double Value;
+    const IntMap<Var, double>&  activity;
+    Value operator() (Var x) const { return activity[x]; }
+    static bool lt(Value x, Value y) { return x > y; }
+    VarOrderPrio(const IntMap<Var, double>&  act) : activity(act) {}
+  };
+
+  struct LitLevelGt {
+    const VarDataMap& vardata;
+    bool operator() (Lit x, Lit y) const {
+      return vardata[var(x)].level > vardata[var(y)].level;
+    }
+    LitLevelGt(const VarDataMap& vd) : vardata(vd) {}
+  };
+
   struct ShrinkStackElem {
     uint32_t i;
     Lit l;
     ShrinkStackElem(uint32_t _i, Lit _l) : i(_i), l(_l) {}
   };
 
+  // At most 'k' of 'lits' are true. 'counted' holds the true ones that
+  // 'propagate()' has seen, in trail order.
+  struct Card {
+    int k;
+    vec<Lit> lits;
+    vec<Lit> counted;
+  };
+
+  // The variables of an XOR constraint, which have the parity 'rhs'.
+  struct Xor {
+    vec<Var> vars;
+    bool rhs;
+  };
+
+  // XOR constraints in reduced row echelon form over GF(2), a row of 'words'
+  // words per constraint. Each row has a basic column that is in no other row,
+  // and watches it and one more column (see 'propagateXors()').
+  struct XorMatrix {
+    int words = 0;
+    vec<uint64_t> bits;
+    vec<char> rhs;
+    vec<int> basic;
+    vec<int> watch;
+
+    int rows() const { return rhs.size(); }
+    uint64_t* row(int r) { return &bits[r * words]; }
+    static bool has(const uint64_t* row, int col) { return row[col / 64] >> (col % 64) & 1; }
+  };
+
   // Solver state:
   //
   // List of problem clauses.
   vec<CRef> clauses;
   // List of learnt clauses.
   vec<CRef> learnts;
+  // List of cardinality constraints.
+  vec<Card> cards;
+  // 'card_occs[lit]' lists the cardinality constraints that 'lit' is in. Only
+  // literals of variables up to the largest one in a constraint have a list.
+  LMap<vec<int>> card_occs;
+  // List of XOR constraints.
+  vec<Xor> xors;
+  // Whether 'xors' changed since 'xor_matrix' was built.
+  bool xors_changed;
+  // The matrix column of each variable in an XOR constraint, or -1, and the
+  // variable of each column.
+  VMap<int> xor_col;
+  vec<Var> xor_vars;
+  XorMatrix xor_matrix;
+  // 'xor_watches[col]' lists the rows that watch 'col', and maybe some that
+  // no longer do.
+  vec<vec<int>> xor_watches;
+  // Copies of the rows that implied variables, with the trail position of
+  // each.
+  vec<uint64_t> xor_reason_rows;
+  vec<int> xor_reason_pos;
+  // The constraint that implied each variable, for a 'CRef_Lazy' reason: a
+  // cardinality constraint if it is at least 0, and otherwise '~i' for the
+  // 'i'th row copy in 'xor_reason_rows'.
+  VMap<int> lazy_reason;
+  // Clauses made by 'explain()' and for conflicts of cardinality and XOR
+  // constraints, which are not attached and are freed once no longer reasons.
+  vec<CRef> explanations;
   // Assignment stack; stores all assigments made in the order they were made.
   vec<Lit> trail;
   // Separator indices for different decision levels in 'trail'.
@@ -226,23 +449,41 @@ public:
 
   // A heuristic measurement of the activity of a variable.
   VMap<double> activity;
+#if defined(MINISAT_PACKED_VARS)
+  VMap<VarState> var_state;
+  // The current assignments.
+  VarField<lbool, &VarState::value> assigns{var_state};
+  // The preferred polarity of each variable.
+  VarField<char, &VarState::polarity> polarity{var_state};
+#else
   // The current assignments.
   VMap<lbool> assigns;
   // The preferred polarity of each variable.
   VMap<char> polarity;
+#endif
   // The users preferred polarity of each variable.
   VMap<lbool> user_pol;
+  // The polarity of each variable in the largest conflict-free trail since
+  // the last restart, and since the last rephasing.
+  VMap<char> target_pol;
+  VMap<char> best_pol;
   // Declares if a variable is eligible for selection in the decision heuristic.
   VMap<char> decision;
+  // The literal a substituted variable is equivalent to, or 'lit_Undef'.
+  VMap<Lit> equiv;
   // Stores reason and level for each variable.
+#if defined(MINISAT_PACKED_VARS)
+  VarDataMap vardata{var_state};
+#else
   VMap<VarData> vardata;
+#endif
   // 'watches[lit]' is a list of constraints watching 'lit' (will go there if
   // literal becomes true).
-  OccLists<Lit, vec<Watcher>, WatcherDeleted, MkIndexLit> watches;
+  WatchLists watches;
 
   // A priority queue of variables ordered with respect to the variable
   // activity.
-  Heap<Var,VarOrderLt> order_heap;
+  CachedHeap<Var,VarOrderPrio> order_heap;
 
   // If FALSE, the constraints are already unsatisfiable. No part of the solver
   // state may be used!
@@ -262,10 +503,31 @@ public:
   // Set by 'search()'.
   double progress_estimate;
   // Indicates whether possibly inefficient linear scan for satisfied clauses
-  // should be performed in 'simplify'.
+  // should be performed in 'simplify'. Cleared while 'SimpSolver' keeps
+  // occurrence lists of the original clauses, which must then not be changed
+  // in place by 'simplify' or 'vivify'. Equivalent-literal substitution is the
+  // exception; 'SimpSolver' rebuilds its lists when 'equiv_lits' moves.
   bool remove_satisfied;
   // Next variable to be created.
   Var next_var;
+  // Value of 'propagations' at the end of the last vivification.
+  uint64_t vivify_props;
+  // Value of 'propagations' at the end of the last probing.
+  uint64_t probe_props;
+  // The literal (as an index) that the next probing pass starts from.
+  int probe_next;
+  // Value of 'propagations' at the last local search.
+  uint64_t walk_props;
+  // The sizes of the trails saved in 'target_pol' and 'best_pol'.
+  int target_assigned;
+  int best_assigned;
+  // Value of 'conflicts' at which to rephase next.
+  uint64_t next_rephase;
+  // Clauses of the variables removed from the clause database, used to extend
+  // the model. Each clause is stored with the literal of its removed variable
+  // first and is followed by its size. The clauses of a variable form one
+  // block that ends with a unit clause giving its default value.
+  vec<uint32_t> elimclauses;
   ClauseAllocator ca;
 
   vec<Var> released_vars;
@@ -275,13 +537,20 @@ public:
   // the method in which it is used, exept 'seen' wich is used in several
   // places.
   //
+#if defined(MINISAT_PACKED_VARS)
+  VarField<char, &VarState::seen> seen{var_state};
+#else
   VMap<char> seen;
+#endif
   vec<ShrinkStackElem> analyze_stack;
   vec<Lit> analyze_toclear;
+  vec<Lit> shrink_toclear;
 
   double max_learnts;
   double learntsize_adjust_confl;
   int learntsize_adjust_cnt;
+  // Value of 'conflicts' at which to compact the clause arena next.
+  uint64_t next_compact;
 
   // Resource contraints:
   //
@@ -305,21 +574,88 @@ public:
   bool enqueue(Lit p, CRef from = CRef_Undef);
   // Perform unit propagation. Returns possibly conflicting clause.
   CRef propagate();
+  // (helper method for 'propagate()')
+  CRef propagateCards(Lit p);
+  // (helper method for 'propagate()')
+  CRef propagateXors(Lit p);
+  // Bring 'xors' into 'xor_matrix' (at level 0). Returns false if they are
+  // inconsistent.
+  bool buildXorMatrix();
+  // Make 'col' the basic column of row 'r'. Returns possibly conflicting
+  // clause.
+  CRef pivotXor(int r, int col);
+  // Propagate row 'r' if it has at most one unassigned column. Returns
+  // possibly conflicting clause.
+  CRef impliedXor(int r);
+  // A column of row 'r' but 'skip' to watch: an unassigned one if any, and
+  // otherwise the one assigned at the highest level.
+  int xorWatchCandidate(int r, int skip);
+  // The reason of 'x', made into a clause if it is 'CRef_Lazy'.
+  CRef explain(Var x);
+  // Free the clauses in 'explanations' that are not reasons.
+  void sweepExplanations();
+  // Whether 'x' is in a cardinality or XOR constraint.
+  bool inConstraint(Var x) const;
   // Backtrack until a certain level.
-  void cancelUntil(int level);
+  void cancelUntil(int level, bool save_phases = true);
+  // The level to backtrack to on restart when reusing the trail.
+  int reuseTrailLevel(const vec<Lit>& assumptions);
+  // Save the first 'assigned' literals of the trail as target and best
+  // phases, if they are more than the saved ones.
+  void updateTargetPhases(int assigned);
+  // Reset the saved phases to the next ones in the rephasing cycle.
+  void rephase();
   // (bt = backtrack)
   void analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel);
   // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
   void analyzeFinal(Lit p, LSet& out_conflict);
   // (helper method for 'analyze()')
   bool litRedundant(Lit p);
+  // Replace the literals of each decision level in a learnt clause by the
+  // unique implication point of that level, where possible.
+  void shrinkLearnt(vec<Lit>& out_learnt);
+  // (helper method for 'shrinkLearnt()')
+  Lit shrinkLevel(const vec<Lit>& out_learnt, int begin, int end, int lev);
+  // Remove the literals of a learnt clause that are implied by its asserting
+  // literal through a binary clause.
+  void binaryMinimize(vec<Lit>& out_learnt);
   // Search for a given number of conflicts.
   lbool search(int nof_conflicts, const vec<Lit>& assumptions);
   // Reduce the set of learnt clauses.
   void reduceDB();
+  // Copy the statistics into 'stats'.
+  void publishStats();
+  // Print the progress and memory usage after a restart (with 'verbosity').
+  void printProgress() const;
   // Shrink 'cs' to contain only non-satisfied clauses.
   void removeSatisfied(vec<CRef>& cs);
-  void rebuildOrderHeap();
+  // Shorten clauses by propagating the negation of their literals at the root
+  // level.
+  bool vivify();
+  // (helper method for 'vivify()')
+  bool vivifyClause(CRef cr);
+  // Learn failed and implied literals and substitute equivalent literals.
+  bool probe();
+  // (helper method for 'probe()')
+  bool probeLit(Lit p);
+  // (helper method for 'probe()')
+  bool substituteEquivs();
+  // Assign the literals of 'cube' at new decision levels, and look ahead on
+  // the first free candidates in 'order' to extend it by failed literals and
+  // to choose 'out_split' (or 'var_Undef' if none is free), with which 'out_pos'
+  // and 'out_neg' variables are assigned. Returns false if 'cube' is refuted.
+  bool lookaheadCube(vec<Lit>& cube, const vec<Var>& order, Var& out_split,
+                     int& out_pos, int& out_neg);
+  // (helper method for 'lookaheadCube()') Returns the number of literals that
+  // 'p' implies at a new decision level, or -1 if it fails.
+  int lookahead(Lit p);
+  // (helper method for 'substituteEquivs()')
+  bool substituteClauses(vec<CRef>& cs, vec<Lit>& units);
+  // Binary clauses over unassigned decision variables, as implication edges
+  // 'edges[start[toInt(p)] .. start[toInt(p)+1]-1]' for each literal 'p'.
+  void buildBinaryGraph(vec<int>& start, vec<Lit>& edges);
+  // Assign the variables on 'elimclauses' in 'model'.
+  void extendModel();
 
   // Maintaining Variable/Clause activity:
   //
@@ -361,6 +697,8 @@ public:
   double progressEstimate()      const;
   bool withinBudget()      const;
   void relocAll(ClauseAllocator& to);
+  // Whether garbage collection should compact the clause arena in place.
+  bool inPlaceGC() const;
 
   // Static helpers:
   //
@@ -399,6 +737,7 @@ inline void Solver::varBumpActivity(Var v, double inc) {
     for (int i = 0; i < nVars(); i++)
       activity[i] *= 1e-100;
     var_inc *= 1e-100;
+    order_heap.refresh();
   }
 
   // Update order_heap with respect to new activity:
@@ -416,6 +755,10 @@ inline void Solver::claBumpActivity (Clause& c) {
   }
 }
 
+inline bool Solver::inPlaceGC() const {
+  return inplace_gc_lim >= 0 &&
+      (uint64_t)ca.size() * ClauseAllocator::Unit_Size >= (uint64_t)inplace_gc_lim << 20;
+}
 inline void Solver::checkGarbage() { return checkGarbage(garbage_frac); }
 inline void Solver::checkGarbage(double gf) {
   if (ca.wasted() > ca.size() * gf)
@@ -433,9 +776,19 @@ inline bool Solver::enqueue(Lit p, CRef from) {
 inline bool Solver::isRemoved(CRef cr) const { return ca[cr].mark() == 1; }
 
 inline bool Solver::locked(const Clause& c) const {
-  return value(c[0]) == l_True &&
-      reason(var(c[0])) != CRef_Undef &&
-      ca.lea(reason(var(c[0]))) == &c;
+  // 'propagate()' does not order a binary clause, so either literal may be the implied one:
+  for (int i = 0; i < (c.size() == 2 ? 2 : 1); i++) {
+    if (value(c[i]) == l_True &&
+        reason(var(c[i])) != CRef_Undef && reason(var(c[i])) != CRef_Lazy &&
+        ca.lea(reason(var(c[i]))) == &c)
+      return true;
+  }
+  return false;
+}
+inline bool Solver::inConstraint(Var x) const {
+  return (card_occs.has(mkLit(x, true)) &&
+          (card_occs[mkLit(x, false)].size() > 0 || card_occs[mkLit(x, true)].size() > 0)) ||
+      (xor_col.has(x) && xor_col[x] >= 0);
 }
 
 inline void Solver::newDecisionLevel() { trail_lim.push(trail.size()); }
@@ -448,6 +801,11 @@ inline lbool Solver::value(Var x) const { return assigns[x]; }
 inline lbool Solver::value(Lit p) const { return assigns[var(p)] ^ sign(p); }
 inline lbool Solver::modelValue(Var x) const { return model[x]; }
 inline lbool Solver::modelValue(Lit p) const { return model[var(p)] ^ sign(p); }
+inline Lit Solver::repr(Lit p) const {
+  while (equiv[var(p)] != lit_Undef)
+    p = equiv[var(p)] ^ sign(p);
+  return p;
+}
 inline int Solver::nAssigns() const { return trail.size(); }
 inline int Solver::nClauses() const { return num_clauses; }
 inline int Solver::nLearnts() const { return num_learnts; }
@@ -465,7 +823,12 @@ inline void Solver::setDecisionVar(Var v, bool b) {
     dec_vars--;
 
   decision[v] = b;
-  insertVarOrder(v);
+  // Assigned variables are skipped lazily by 'pickBranchLit()', but non-decision ones (e.g.
+  // eliminated or substituted variables) leave the heap right away:
+  if (!b && order_heap.inHeap(v))
+    order_heap.remove(v);
+  else
+    insertVarOrder(v);
 }
 inline void Solver::setConfBudget(int64_t x) {
   conflict_budget = conflicts + x;
@@ -484,6 +847,8 @@ inline bool Solver::withinBudget() const {
       (propagation_budget < 0 || propagations < (uint64_t)propagation_budget);
 }
 
+inline bool Solver::addClause(vec<Lit> ps) { return addClause_(ps); }
+
 inline bool Solver::solve(const vec<Lit>& assumptions) {
   budgetOff();
   return solveLimited(assumptions) == l_True;
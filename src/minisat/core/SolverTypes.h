@@ -29,6 +29,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "minisat/mtl/Vec.h"
 #include "minisat/mtl/IntMap.h"
 #include "minisat/mtl/Map.h"
+#include "minisat/mtl/Sort.h"
 #include "minisat/mtl/Alloc.h"
 
 namespace Minisat {
@@ -153,7 +154,14 @@ lbool lbool::fromBool(bool b) {
 // Clause -- a simple class for representing a clause:
 
 class Clause;
-typedef RegionAllocator<uint32_t>::Ref CRef;
+// Clause references are 32-bit word offsets unless the build asks for 64-bit ones
+// (MINISAT_64BIT). Their top bit is left free for 'CRef_Binary':
+#if defined(MINISAT_64BIT)
+typedef RegionAllocator<uint32_t, uint64_t, 63> ClauseRegion;
+#else
+typedef RegionAllocator<uint32_t, uint32_t, 31> ClauseRegion;
+#endif
+typedef ClauseRegion::Ref CRef;
 
 class Clause {
   struct {
@@ -161,17 +169,36 @@ class Clause {
     unsigned learnt    : 1;
     unsigned has_extra : 1;
     unsigned reloced   : 1;
-    unsigned size      : 27; }                        header;
-  union { Lit lit; float act; uint32_t abs; CRef rel; } data[0];
+    unsigned vivified  : 1;
+    unsigned size      : 26; }                        header;
+  union { Lit lit; float act; uint32_t abs; } data[0];
 
   friend class ClauseAllocator;
 
+  // The number of words a forwarding reference takes (see 'relocate()'):
+  enum { Rel_Words = sizeof(CRef) / sizeof(uint32_t) };
+
+  // Turn 'words' unused words at 'at' into a deleted clause, so that the region can still be
+  // walked clause by clause (see 'ClauseAllocator::forwardAll()'). A filler is told apart from a
+  // deleted clause by being learnt without the extra field:
+  static void makeFiller(void* at, uint32_t words) {
+    assert(words > 0);
+    Clause& filler = *(Clause*)at;
+    filler.header.mark      = 1;
+    filler.header.learnt    = 1;
+    filler.header.has_extra = 0;
+    filler.header.reloced   = 0;
+    filler.header.vivified  = 0;
+    filler.header.size      = words - 1;
+  }
+
   // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
   Clause(const vec<Lit>& ps, bool use_extra, bool learnt) {
     header.mark      = 0;
     header.learnt    = learnt;
     header.has_extra = use_extra;
     header.reloced   = 0;
+    header.vivified  = 0;
     header.size      = ps.size();
 
     for (int i = 0; i < ps.size(); i++)
@@ -214,9 +241,19 @@ public:
 
   void shrink(int i) {
     assert(i <= size());
+    if (i == 0)
+      return;
+    int words = header.size + (int)header.has_extra;
     if (header.has_extra)
       data[header.size-i] = data[header.size];
     header.size -= i;
+
+    // Keep room for a forwarding reference:
+    int new_words = header.size + (int)header.has_extra;
+    if (new_words < Rel_Words)
+      new_words = Rel_Words;
+    if (words > new_words)
+      makeFiller(&data[new_words], words - new_words);
   }
 
   void pop() { shrink(1); }
@@ -226,12 +263,20 @@ public:
   void mark(uint32_t m) { header.mark = m; }
   const Lit& last() const { return data[header.size-1].lit; }
 
+  bool vivified() const { return header.vivified; }
+  void vivified(bool b) { header.vivified = b; }
+
   bool reloced() const { return header.reloced; }
-  CRef relocation() const { return data[0].rel; }
+  CRef relocation() const {
+    CRef c;
+    memcpy(&c, data, sizeof(CRef));
+    return c;
+  }
 
+  // NOTE: the reference overwrites the first 'Rel_Words' words after the header.
   void relocate(CRef c) {
     header.reloced = 1;
-    data[0].rel = c;
+    memcpy(data, &c, sizeof(CRef));
   }
 
   // NOTE: somewhat unsafe to change the clause in-place! Must manually call
@@ -259,20 +304,52 @@ public:
 //=================================================================================================
 // ClauseAllocator -- a simple class for allocating memory for clauses:
 
-const CRef CRef_Undef = RegionAllocator<uint32_t>::Ref_Undef;
+const CRef CRef_Undef = ClauseRegion::Ref_Undef;
+// The reason of a literal implied by a cardinality constraint, until it is explained by a clause
+// (see 'Solver::explain()'). Like 'CRef_Undef', it is past the end of any region.
+const CRef CRef_Lazy = CRef_Undef - 1;
+// The top bit, which no clause reference has. It tags the watchers of binary clauses (see
+// 'Solver::Watcher').
+const CRef CRef_Binary = (CRef)1 << (8 * sizeof(CRef) - 1);
 class ClauseAllocator {
-  RegionAllocator<uint32_t> ra;
+  ClauseRegion ra;
 
+  // NOTE: a clause always has room for a forwarding reference.
   static uint32_t clauseWord32Size(int size, bool has_extra){
-    return (sizeof(Clause) + (sizeof(Lit) * (size + (int)has_extra))) / sizeof(uint32_t);
+    int words = size + (int)has_extra;
+    if (words < Clause::Rel_Words)
+      words = Clause::Rel_Words;
+    return (sizeof(Clause) + (sizeof(Lit) * words)) / sizeof(uint32_t);
+  }
+
+  static uint32_t wordSize(const Clause& c) {
+    if (c.learnt() && !c.has_extra())
+      return 1 + c.size();   // A filler.
+    return clauseWord32Size(c.size(), c.has_extra());
+  }
+
+  CRef allocWords(uint32_t words) {
+    CRef end = ra.size();
+    CRef cid = ra.alloc(words);
+    fill(end, cid);
+    return cid;
+  }
+
+  // Fill the words skipped at the end of a segment with deleted clauses:
+  void fill(CRef from, CRef to) {
+    while (from < to) {
+      CRef end = ra.segmentEnd(from) < to ? ra.segmentEnd(from) : to;
+      Clause::makeFiller(lea(from), end - from);
+      from = end;
+    }
   }
 
  public:
-  enum { Unit_Size = RegionAllocator<uint32_t>::Unit_Size };
+  enum { Unit_Size = ClauseRegion::Unit_Size };
 
   bool extra_clause_field;
 
-  ClauseAllocator(uint32_t start_cap) : ra(start_cap), extra_clause_field(false){}
+  ClauseAllocator(CRef start_cap) : ra(start_cap), extra_clause_field(false){}
   ClauseAllocator() : extra_clause_field(false){}
 
   void moveTo(ClauseAllocator& to){
@@ -284,7 +361,7 @@ class ClauseAllocator {
     assert(sizeof(Lit)      == sizeof(uint32_t));
     assert(sizeof(float)    == sizeof(uint32_t));
     bool use_extra = learnt | extra_clause_field;
-    CRef cid       = ra.alloc(clauseWord32Size(ps.size(), use_extra));
+    CRef cid       = allocWords(clauseWord32Size(ps.size(), use_extra));
     new (lea(cid)) Clause(ps, use_extra, learnt);
 
     return cid;
@@ -292,13 +369,14 @@ class ClauseAllocator {
 
   CRef alloc(const Clause& from) {
     bool use_extra = from.learnt() | extra_clause_field;
-    CRef cid = ra.alloc(clauseWord32Size(from.size(), use_extra));
+    CRef cid = allocWords(clauseWord32Size(from.size(), use_extra));
     new (lea(cid)) Clause(from, use_extra);
     return cid;
   }
 
-  uint32_t size() const { return ra.size(); }
-  uint32_t wasted() const { return ra.wasted(); }
+  CRef size() const { return ra.size(); }
+  CRef wasted() const { return ra.wasted(); }
+  uint64_t memoryUsage() const { return ra.memoryUsage(); }
 
   // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
   Clause& operator[](CRef r) { return (Clause&)ra[r]; }
@@ -308,8 +386,7 @@ class ClauseAllocator {
   CRef ael(const Clause* t){ return ra.ael((uint32_t*)t); }
 
   void free(CRef cid) {
-    Clause& c = operator[](cid);
-    ra.free(clauseWord32Size(c.size(), c.has_extra()));
+    ra.free(wordSize(operator[](cid)));
   }
 
   void reloc(CRef& cr, ClauseAllocator& to) {
@@ -320,9 +397,66 @@ class ClauseAllocator {
       return;
     }
 
+    // When compacting in place, every live clause is already forwarded:
+    assert(&to != this);
     cr = to.alloc(c);
     c.relocate(cr);
   }
+
+  // In-place (sliding) compaction. 'forwardAll()' walks the region in address order and forwards
+  // every clause that is not deleted to the place it will slide down to. The forwarding pointer
+  // overwrites the first words of the clause, which are saved in 'displaced'. All references are
+  // then updated with 'reloc(cr, *this)', and 'slideAll()' finally moves the clauses.
+  void forwardAll(vec<Lit>& displaced) {
+    displaced.clear();
+    CRef to = 0;
+    for (CRef cr = 0; cr < ra.size(); ) {
+      Clause& c = operator[](cr);
+      uint32_t sz = wordSize(c);
+      if (c.mark() != 1) {
+        assert(c.size() > 0);
+        uint32_t words =
+            clauseWord32Size(c.size(), c.has_extra() && (c.learnt() || extra_clause_field));
+        to = ra.fit(to, words);
+        for (int i = 0; i < Clause::Rel_Words; i++)
+          displaced.push(c.data[i].lit);
+        c.relocate(to);
+        to += words;
+      }
+      cr += sz;
+    }
+  }
+
+  void slideAll(const vec<Lit>& displaced) {
+    int k = 0;
+    CRef to = 0;
+    for (CRef cr = 0; cr < ra.size(); ) {
+      Clause& c = operator[](cr);
+      int size = c.size();
+      uint32_t sz = wordSize(c);
+      if (c.reloced()) {
+        fill(to, c.relocation());
+        to = c.relocation();
+        bool use_extra = c.has_extra() && (c.learnt() || extra_clause_field);
+
+        // The destination is never above the source, so copying upwards is safe:
+        Clause& d = operator[](to);
+        d.header = c.header;
+        d.header.reloced = 0;
+        d.header.has_extra = use_extra;
+        for (int i = 0; i < Clause::Rel_Words; i++)
+          d.data[i].lit = displaced[k++];
+        for (int i = Clause::Rel_Words; i < size; i++)
+          d.data[i] = c.data[i];
+        if (use_extra && size >= Clause::Rel_Words)
+          d.data[size] = c.data[size];
+        to += clauseWord32Size(size, use_extra);
+      }
+      cr += sz;
+    }
+    assert(k == displaced.size());
+    ra.truncate(to);
+  }
 };
 
 //=================================================================================================
@@ -423,13 +557,183 @@ void OccLists<K,Vec,Deleted,MkIndex>::clean(const K& idx) {
   dirty[idx] = 0;
 }
 
+//=================================================================================================
+// OccPool -- occurence lists with lazy deletion like 'OccLists', but all stored in one region
+// instead of a vector each:
+//
+// Each key has a block in the region with room for 'cap' elements. A list that outgrows its block
+// moves to a block of twice the size at the end of the region, which leaves the old one unused
+// until 'compact()' slides the lists down over the unused blocks. Blocks never move otherwise, so
+// pointers into a list stay valid while other lists grow. NOTE! Elements are copied with
+// 'memcpy' and never destroyed.
+
+template<class K, class T, class Deleted, class MkIndex = MkIndexDefault<K>, class R = uint32_t>
+class OccPool {
+  typedef RegionAllocator<T, R> Region;
+  struct Head { R ref; int size; int cap; };
+
+  Region ra;
+  IntMap<K, Head, MkIndex> heads;
+  IntMap<K, char, MkIndex> dirty;
+  vec<K> dirties;
+  Deleted deleted;
+
+  void grow(Head& h);
+
+ public:
+  // A view of the list of one key; it stays valid until 'compact()':
+  class List {
+    OccPool* pool;
+    Head* h;
+
+   public:
+    List(OccPool& p, Head& _h) : pool(&p), h(&_h) {}
+
+    int size() const { return h->size; }
+    operator T*() { return h->cap > 0 ? pool->ra.lea(h->ref) : nullptr; }
+    const T& operator[](int i) const { assert(i < h->size); return pool->ra[h->ref + i]; }
+    T& operator[](int i) { assert(i < h->size); return pool->ra[h->ref + i]; }
+    T& last() { return (*this)[h->size - 1]; }
+
+    void push(const T& elem) {
+      if (h->size == h->cap)
+        pool->grow(*h);
+      new (pool->ra.lea(h->ref + h->size)) T(elem);
+      h->size++;
+    }
+    void pop() { assert(h->size > 0); h->size--; }
+    void shrink(int nelems) { assert(nelems <= h->size); h->size -= nelems; }
+    void clear(bool dealloc = false) {
+      h->size = 0;
+      if (dealloc && h->cap > 0) {
+        pool->ra.free(h->cap);
+        h->cap = 0;
+      }
+    }
+  };
+
+  OccPool(const Deleted& d, MkIndex _index = MkIndex())
+      : heads(_index),
+        dirty(_index),
+        deleted(d){}
+
+  void init(const K& idx){
+    heads.reserve(idx, Head{Region::Ref_Undef, 0, 0});
+    heads[idx].size = 0;
+    dirty.reserve(idx, 0);
+  }
+
+  List operator[](const K& idx) { return List(*this, heads[idx]); }
+  List lookup(const K& idx) {
+    if (dirty[idx])
+      clean(idx);
+    return List(*this, heads[idx]);
+  }
+
+  void cleanAll();
+  void clean(const K& idx);
+  void smudge(const K& idx) {
+    if (dirty[idx] == 0){
+      dirty[idx] = 1;
+      dirties.push(idx);
+    }
+  }
+
+  // Slide the lists down in place, in address order, over the unused blocks:
+  void compact();
+  // The bytes of the lists, including the unused space of the region:
+  uint64_t memoryUsage() const {
+    return ra.memoryUsage() + heads.memoryUsage() + dirty.memoryUsage() + dirties.memoryUsage();
+  }
+
+  void clear(bool free = true){
+    ra.truncate(0);
+    heads.clear(free);
+    dirty.clear(free);
+    dirties.clear(free);
+  }
+};
+
+template<class K, class T, class Deleted, class MkIndex, class R>
+void OccPool<K,T,Deleted,MkIndex,R>::grow(Head& h) {
+  int cap = h.cap > 0 ? h.cap * 2 : 4;
+  if (cap <= h.cap)
+    trap("OOM");
+  R ref = ra.alloc(cap);
+  if (h.size > 0)
+    memcpy(ra.lea(ref), ra.lea(h.ref), h.size * sizeof(T));
+  if (h.cap > 0)
+    ra.free(h.cap);
+  h.ref = ref;
+  h.cap = cap;
+}
+
+template<class K, class T, class Deleted, class MkIndex, class R>
+void OccPool<K,T,Deleted,MkIndex,R>::compact() {
+  vec<Head*> order;
+  for (Head* h = heads.begin(); h != heads.end(); h++) {
+    if (h->size > 0)
+      order.push(h);
+    else {
+      h->ref = Region::Ref_Undef;
+      h->cap = 0;
+    }
+  }
+  sort(order, [](const Head* x, const Head* y) { return x->ref < y->ref; });
+
+  // A list keeps room for half its size again, so that the next push does not move it to the end
+  // of the region. It never gets more than its old block, so every list lands at or below where it
+  // was, before the lists after it are moved:
+  R to = 0;
+  for (int i = 0; i < order.size(); i++) {
+    Head* h = order[i];
+    int cap = h->size + h->size / 2 + 1;
+    if (cap > h->cap)
+      cap = h->cap;
+    to = ra.fit(to, cap);
+    if (to != h->ref) {
+      // The destination is never above the source, so copying upwards is safe:
+      T* from = ra.lea(h->ref);
+      T* dest = ra.lea(to);
+      for (int k = 0; k < h->size; k++)
+        memcpy(&dest[k], &from[k], sizeof(T));
+    }
+    h->ref = to;
+    h->cap = cap;
+    to += cap;
+  }
+  ra.truncate(to);
+}
+
+template<class K, class T, class Deleted, class MkIndex, class R>
+void OccPool<K,T,Deleted,MkIndex,R>::cleanAll() {
+  for (int i = 0; i < dirties.size(); i++) {
+    // Dirties may contain duplicates so check here if a variable is already cleaned:
+    if (dirty[dirties[i]])
+      clean(dirties[i]);
+  }
+  dirties.clear();
+}
+
+template<class K, class T, class Deleted, class MkIndex, class R>
+void OccPool<K,T,Deleted,MkIndex,R>::clean(const K& idx) {
+  List list = (*this)[idx];
+  int  i, j;
+  for (i = j = 0; i < list.size(); i++) {
+    if (!deleted(list[i]))
+      list[j++] = list[i];
+  }
+  list.shrink(i - j);
+  dirty[idx] = 0;
+}
+
 //=================================================================================================
 // CMap -- a class for mapping clauses to values:
 
 template<class T>
 class CMap {
   struct CRefHash {
-    uint32_t operator()(CRef cr) const { return (uint32_t)cr; }
+    uint32_t operator()(CRef cr) const { return (uint32_t)(cr ^ (cr >> 31 >> 1)); }
   };
 
   typedef Map<CRef, T, CRefHash> HashTable;
@@ -28,97 +28,171 @@ namespace Minisat {
 
 //=================================================================================================
 // Simple Region-based memory allocator:
-
-template<class T>
+//
+// The region is a sequence of segments that are allocated on demand. Segment 'k' holds
+// '2^(k+Shift)' elements and starts at '(2^k - 1) * 2^Shift', so a reference is still a plain
+// offset into the region, and growing it never copies what is already there. A table with one
+// entry per '2^Shift' elements maps a reference to its segment with a single load. An allocation
+// never spans two segments; the elements skipped at the end of a segment are left to the caller
+// (see 'fit()').
+//
+// 'R' is the (unsigned) reference type. References stay below '2^Bits', which bounds the size of
+// the region and leaves the bits above it to the caller.
+
+template<class T, class R = uint32_t, int Bits = 8 * sizeof(R)>
 class RegionAllocator {
-  T* memory = nullptr;
-  uint32_t sz = 0;
-  uint32_t cap = 0;
-  uint32_t wasted_ = 0;
-
-  void capacity(uint32_t min_cap);
+  // The first segment holds '2^Shift' elements:
+  enum { Shift = 12, Max_Segments = Bits - Shift };
+
+  T* segs[Max_Segments] = {};
+  // For every 2^Shift elements, the address of their segment minus the start of the segment, so
+  // that a scaled reference can be added directly:
+  uintptr_t* pages = nullptr;
+  uint32_t nsegs = 0;
+  R sz = 0;
+  R wasted_ = 0;
+
+  static uint32_t segment(R r) { return 63 - __builtin_clzll((uint64_t)(r >> Shift) + 1); }
+  static uint64_t segmentStart(uint32_t k) { return (((uint64_t)1 << k) - 1) << Shift; }
+  void capacity(R min_cap);
+  void release();
 
  public:
   // TODO: make this a class for better type-checking?
-  typedef uint32_t Ref;
-  enum { Ref_Undef = UINT32_MAX };
+  typedef R Ref;
+  static constexpr Ref Ref_Undef = (Ref)-1;
   enum { Unit_Size = sizeof(T) };
 
-  explicit RegionAllocator(uint32_t start_cap = 1024*1024) {
+  explicit RegionAllocator(Ref start_cap = 0) {
     capacity(start_cap);
   }
 
   ~RegionAllocator() {
-    ::free(memory);
+    release();
   }
 
-  uint32_t size() const { return sz; }
-  uint32_t wasted() const { return wasted_; }
+  Ref size() const { return sz; }
+  Ref wasted() const { return wasted_; }
+  // The bytes of the segments and their page table:
+  uint64_t memoryUsage() const {
+    uint64_t cap = segmentStart(nsegs);
+    return cap * sizeof(T) + (cap >> Shift) * sizeof(uintptr_t);
+  }
 
   Ref alloc(int size); 
   void free(int size){ wasted_ += size; }
+  // Drop everything from 'new_sz' on, after the live data has been compacted below it.
+  void truncate(Ref new_sz);
+
+  // The first reference at or after 'r' where 'size' elements fit in one segment, and the end of
+  // the segment 'r' is in:
+  Ref fit(Ref r, int size) const;
+  Ref segmentEnd(Ref r) const { return (Ref)segmentStart(segment(r) + 1); }
 
   // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
-  T& operator[](Ref r) { assert(r < sz); return memory[r]; }
-  const T& operator[](Ref r) const { assert(r < sz); return memory[r]; }
+  T& operator[](Ref r) { return *lea(r); }
+  const T& operator[](Ref r) const { return *lea(r); }
 
-  T* lea(Ref r) { assert(r < sz); return &memory[r]; }
-  const T* lea(Ref r) const { assert(r < sz); return &memory[r]; }
+  T* lea(Ref r) {
+    assert(r < sz);
+    return (T*)(pages[r >> Shift] + (uintptr_t)r * sizeof(T));
+  }
+  const T* lea(Ref r) const {
+    assert(r < sz);
+    return (const T*)(pages[r >> Shift] + (uintptr_t)r * sizeof(T));
+  }
   Ref ael(const T* t) {
-    assert((void*)t >= (void*)&memory[0]);
-    assert((void*)t < (void*)&memory[sz-1]);
-    return (Ref)(t - &memory[0]);
+    for (uint32_t k = 0; k < nsegs; k++) {
+      if (t >= segs[k] && t < segs[k] + ((size_t)1 << (Shift + k)))
+        return (Ref)(segmentStart(k) + (t - segs[k]));
+    }
+    assert(false);
+    return Ref_Undef;
   }
 
   void moveTo(RegionAllocator& to) {
-    ::free(to.memory);
-    to.memory = memory;
+    to.release();
+    for (uint32_t k = 0; k < nsegs; k++) {
+      to.segs[k] = segs[k];
+      segs[k] = nullptr;
+    }
+    to.pages = pages;
+    to.nsegs = nsegs;
     to.sz = sz;
-    to.cap = cap;
     to.wasted_ = wasted_;
 
-    memory = nullptr;
-    sz = cap = wasted_ = 0;
+    pages = nullptr;
+    nsegs = 0;
+    sz = wasted_ = 0;
   }
 };
 
-template<class T>
-void RegionAllocator<T>::capacity(uint32_t min_cap) {
-  if (cap >= min_cap) return;
+template<class T, class R, int Bits>
+void RegionAllocator<T, R, Bits>::release() {
+  for (uint32_t k = 0; k < nsegs; k++) {
+    ::free(segs[k]);
+    segs[k] = nullptr;
+  }
+  ::free(pages);
+  pages = nullptr;
+  nsegs = 0;
+}
 
-  uint32_t prev_cap = cap;
-  while (cap < min_cap){
-    // NOTE: Multiply by a factor (13/8) without causing overflow, then add 2 and make the
-    // result even by clearing the least significant bit. The resulting sequence of capacities
-    // is carefully chosen to hit a maximum capacity that is close to the '2^32-1' limit when
-    // using 'uint32_t' as indices so that as much as possible of this space can be used.
-    uint32_t delta = ((cap >> 1) + (cap >> 3) + 2) & ~1;
-    cap += delta;
+template<class T, class R, int Bits>
+void RegionAllocator<T, R, Bits>::capacity(R min_cap) {
+  while (segmentStart(nsegs) < min_cap) {
+    // The last segment ends at '2^Bits - 2^Shift', below 'Ref_Undef':
+    if (nsegs == Max_Segments || ((size_t)-1 >> (Shift + nsegs)) < sizeof(T))
+      trap("OOM");
+    segs[nsegs] = (T*)malloc(sizeof(T) << (Shift + nsegs));
+    if (!segs[nsegs])
+      trap("OOM");
+    nsegs++;
 
-    if (cap <= prev_cap)
+    size_t first = (size_t)(segmentStart(nsegs - 1) >> Shift);
+    size_t end = (size_t)(segmentStart(nsegs) >> Shift);
+    pages = (uintptr_t*)realloc(pages, sizeof(uintptr_t) * end);
+    if (!pages)
       trap("OOM");
+    for (size_t i = first; i < end; i++)
+      pages[i] = (uintptr_t)segs[nsegs - 1] - (uintptr_t)first * (sizeof(T) << Shift);
   }
-
-  assert(cap > 0);
-  memory = (T*)realloc(memory, sizeof(T) * cap);
-  if (!memory)
-    trap("OOM");
 }
 
-template<class T>
-typename RegionAllocator<T>::Ref
-RegionAllocator<T>::alloc(int size) { 
-  assert(size > 0);
-  capacity(sz + size);
+template<class T, class R, int Bits>
+void RegionAllocator<T, R, Bits>::truncate(R new_sz) {
+  assert(new_sz <= sz);
+  sz = new_sz;
+  wasted_ = 0;
+
+  // Keep one empty segment around, so that growing again does not hit the allocator at once:
+  while (nsegs > 1 && segmentStart(nsegs - 2) >= sz) {
+    nsegs--;
+    ::free(segs[nsegs]);
+    segs[nsegs] = nullptr;
+  }
+}
 
-  uint32_t prev_sz = sz;
-  sz += size;
-    
-  // Handle overflow:
-  if (sz < prev_sz)
+template<class T, class R, int Bits>
+typename RegionAllocator<T, R, Bits>::Ref
+RegionAllocator<T, R, Bits>::fit(Ref r, int size) const {
+  uint64_t start = r;
+  uint32_t k = segment(r);
+  while (k < Max_Segments && start + size > segmentStart(k + 1))
+    start = segmentStart(++k);
+  if (k == Max_Segments)
     trap("OOM");
+  return (Ref)start;
+}
 
-  return prev_sz;
+template<class T, class R, int Bits>
+typename RegionAllocator<T, R, Bits>::Ref
+RegionAllocator<T, R, Bits>::alloc(int size) { 
+  assert(size > 0);
+  Ref r = fit(sz, size);
+  capacity(r + size);
+  sz = r + size;
+  return r;
 }
 
 }  // namespace Minisat
@@ -105,10 +105,13 @@ class Heap {
     indices[k] = -1;
 
     if (k_pos < heap.size()-1) {
-      heap[k_pos]          = heap.last();
-      indices[heap[k_pos]] = k_pos;
+      K moved              = heap.last();
+      heap[k_pos]          = moved;
+      indices[moved]       = k_pos;
       heap.pop();
-      percolateDown(k_pos);
+      // The moved element came from another subtree, so it may have to go either way:
+      percolateUp(k_pos);
+      percolateDown(indices[moved]);
     } else {
       heap.pop();
     }
@@ -150,6 +153,160 @@ class Heap {
   }
 };
 
+//=================================================================================================
+// A d-ary heap that keeps a copy of each element's priority next to the element, so that
+// comparisons stay within the heap's own memory instead of looking the priorities up elsewhere.
+//
+// 'Prio' gives the priority of an element ('Prio::Value operator()(K)') and orders priorities
+// ('static bool lt(Value, Value)'). After the priority of an element changes, call 'decrease',
+// 'increase' or 'update' for it, or 'refresh' if all of them changed without changing their order.
+
+template<class K, class Prio, class MkIndex = MkIndexDefault<K>, int D = 4>
+class CachedHeap {
+  typedef typename Prio::Value Value;
+  struct Entry { Value p; K k; };
+
+  vec<Entry> heap; // Heap of Keys with their priorities
+  IntMap<K,int,MkIndex> indices; // Each Key's position (index) in the Heap
+  Prio prio;
+
+  static int child(int i) { return i*D+1; }
+  static int parent(int i) { return (i-1) / D; }
+
+  void percolateUp(int i) {
+    Entry x = heap[i];
+    while (i != 0) {
+      int p = parent(i);
+      if (!Prio::lt(x.p, heap[p].p))
+        break;
+      heap[i] = heap[p];
+      indices[heap[i].k] = i;
+      i = p;
+    }
+    heap[i] = x;
+    indices[x.k] = i;
+  }
+
+  void percolateDown(int i) {
+    Entry x = heap[i];
+    for (;;) {
+      int first = child(i);
+      if (first >= heap.size())
+        break;
+      int last = first + D < heap.size() ? first + D : heap.size();
+      int best = first;
+      for (int c = first + 1; c < last; c++) {
+        if (Prio::lt(heap[c].p, heap[best].p))
+          best = c;
+      }
+      if (!Prio::lt(heap[best].p, x.p))
+        break;
+      heap[i] = heap[best];
+      indices[heap[i].k] = i;
+      i = best;
+    }
+    heap[i] = x;
+    indices[x.k] = i;
+  }
+
+ public:
+  CachedHeap(const Prio& p, MkIndex _index = MkIndex()) : indices(_index), prio(p) {}
+
+  int size() const { return heap.size(); }
+  uint64_t memoryUsage() const { return heap.memoryUsage() + indices.memoryUsage(); }
+  bool empty() const { return heap.size() == 0; }
+  bool inHeap(K k) const { return indices.has(k) && indices[k] >= 0; }
+  K operator[](int index) const { assert(index < heap.size()); return heap[index].k; }
+
+  void decrease(K k) {
+    assert(inHeap(k));
+    int i = indices[k];
+    heap[i].p = prio(k);
+    percolateUp(i);
+  }
+  void increase(K k) {
+    assert(inHeap(k));
+    int i = indices[k];
+    heap[i].p = prio(k);
+    percolateDown(i);
+  }
+
+  // Safe variant of insert/decrease/increase:
+  void update(K k) {
+    if (!inHeap(k)) {
+      insert(k);
+    } else {
+      int i = indices[k];
+      heap[i].p = prio(k);
+      percolateUp(i);
+      percolateDown(indices[k]);
+    }
+  }
+
+  // Reload all priorities, which must have kept their order:
+  void refresh() {
+    for (int i = 0; i < heap.size(); i++)
+      heap[i].p = prio(heap[i].k);
+  }
+
+  void insert(K k) {
+    indices.reserve(k, -1);
+    assert(!inHeap(k));
+
+    indices[k] = heap.size();
+    heap.push(Entry{prio(k), k});
+    percolateUp(indices[k]);
+  }
+
+  void remove(K k) {
+    assert(inHeap(k));
+
+    int k_pos  = indices[k];
+    indices[k] = -1;
+
+    if (k_pos < heap.size()-1) {
+      heap[k_pos]            = heap.last();
+      indices[heap[k_pos].k] = k_pos;
+      K moved                = heap[k_pos].k;
+      heap.pop();
+      percolateUp(k_pos);
+      percolateDown(indices[moved]);
+    } else {
+      heap.pop();
+    }
+  }
+
+  K removeMin() {
+    K x = heap[0].k;
+    heap[0] = heap.last();
+    indices[heap[0].k] = 0;
+    indices[x] = -1;
+    heap.pop();
+    if (heap.size() > 1)
+      percolateDown(0);
+    return x;
+  }
+
+  // Rebuild the heap from scratch, using the elements in 'ns':
+  void build(const vec<K>& ns) {
+    clear();
+    for (int i = 0; i < ns.size(); i++) {
+      indices.reserve(ns[i], -1);
+      indices[ns[i]] = i;
+      heap.push(Entry{prio(ns[i]), ns[i]});
+    }
+
+    for (int i = parent(heap.size() - 1); i >= 0; i--)
+      percolateDown(i);
+  }
+
+  void clear(bool dispose = false) {
+    for (int i = 0; i < heap.size(); i++)
+      indices[heap[i].k] = -1;
+    heap.clear(dispose);
+  }
+};
+
 }
 
 #endif
@@ -53,6 +53,7 @@ class IntMap {
   void insert (K key, V val) { reserve(key); operator[](key) = val; }
 
   void clear(bool dispose = false) { map.clear(dispose); }
+  uint64_t memoryUsage() const { return map.memoryUsage(); }
   void moveTo(IntMap& to) { map.moveTo(to.map); to.index = index; }
   void copyTo(IntMap& to) const { map.copyTo(to.map); to.index = index; }
 };
@@ -53,10 +53,21 @@ void selectionSort(T* array, int size) {
   selectionSort(array, size, LessThan_default<T>());
 }
 
+template <class T, class LessThan>
+void insertionSort(T* array, int size, LessThan lt) {
+  for (int i = 1; i < size; i++) {
+    T x = array[i];
+    int j = i;
+    for (; j > 0 && lt(x, array[j-1]); j--)
+      array[j] = array[j-1];
+    array[j] = x;
+  }
+}
+
 template <class T, class LessThan>
 void sort(T* array, int size, LessThan lt) {
-  if (size <= 15) {
-    selectionSort(array, size, lt);
+  if (size <= 16) {
+    insertionSort(array, size, lt);
     return;
   }
 
@@ -83,6 +94,45 @@ void sort(T* array, int size) {
   sort(array, size, LessThan_default<T>());
 }
 
+// Stable LSD radix sort on an unsigned 32-bit key, 'key(x)', one byte per pass. Passes in which
+// all keys have the same byte are skipped:
+template <class T, class Key>
+void radixSort(T* array, int size, Key key) {
+  if (size <= 16) {
+    insertionSort(array, size, [&](const T& x, const T& y) { return key(x) < key(y); });
+    return;
+  }
+
+  int count[4][256] = {};
+  for (int i = 0; i < size; i++) {
+    uint32_t k = key(array[i]);
+    for (int b = 0; b < 4; b++)
+      count[b][(k >> (8 * b)) & 255]++;
+  }
+
+  vec<T> tmp(size);
+  T* from = array;
+  T* to = tmp;
+  for (int b = 0; b < 4; b++) {
+    int* c = count[b];
+    if (c[(key(from[0]) >> (8 * b)) & 255] == size)
+      continue;
+
+    for (int d = 0, sum = 0; d < 256; d++) {
+      int n = c[d];
+      c[d] = sum;
+      sum += n;
+    }
+    for (int i = 0; i < size; i++)
+      to[c[(key(from[i]) >> (8 * b)) & 255]++] = from[i];
+    T* t = from; from = to; to = t;
+  }
+  if (from != array) {
+    for (int i = 0; i < size; i++)
+      array[i] = from[i];
+  }
+}
+
 //=================================================================================================
 // For 'vec's:
 
@@ -95,6 +145,11 @@ template <class T> void sort(vec<T>& v) {
   sort(v, LessThan_default<T>());
 }
 
+template <class T, class Key>
+void radixSort(vec<T>& v, Key key) {
+  radixSort((T*)v, v.size(), key);
+}
+
 //=================================================================================================
 }
 
@@ -23,6 +23,8 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include "irt/utility.h"
 #include "irt/assert.h"
+#include "irt/types.h"
+#include "irt/irt.h"
 
 namespace Minisat {
 
@@ -30,35 +32,59 @@ namespace Minisat {
 // Automatically resizable arrays
 //
 // NOTE! Don't use this vector on datatypes that cannot be re-located in memory (with realloc)
+//
+// The size type is 'int' unless the build asks for 64-bit sizes (MINISAT_64BIT).
+
+#if defined(MINISAT_64BIT)
+typedef int64_t VecSize;
+#else
+typedef int VecSize;
+#endif
 
-template<class T>
+template<class T, class SizeT = VecSize>
 class vec {
  public:
-  typedef int Size;
+  typedef SizeT Size;
  private:
   T* data = nullptr;
-  int sz = 0;
-  int cap = 0;
+  Size sz = 0;
+  // Capacities from 'malloc' are always even. An odd one means that 'data' is storage of the
+  // derived class (see 'svec'):
+  Size cap = 0;
+
+  bool external() const { return cap & 1; }
+
+  static constexpr Size Max_Size =
+      sizeof(Size) == sizeof(int64_t) ? (Size)INT64_MAX : (Size)INT_MAX;
 
   // Don't allow copying (error prone):
-  vec(const vec<T>& other) = delete;
-  vec<T>& operator=(const vec<T>& other) = delete;
-  
+  vec(const vec& other) = delete;
+  vec& operator=(const vec& other) = delete;
+
+  // Move the elements from external storage to the heap:
+  void own();
+
+ protected:
+  // Start out in the external buffer 'buf' of 'size' elements, an odd number:
+  vec(T* buf, Size size) : data(buf), cap(size) { assert(size & 1); }
+
  public:
-  vec(vec<T>&& other) {
+  vec(vec&& other) {
     swap(other);
   }
 
-  vec<T>& operator=(vec<T>&& other) {
-    vec<T> tmp(std::move(other));
+  vec& operator=(vec&& other) {
+    vec tmp(std::move(other));
     swap(tmp);
     return *this;
   }
 
-  static int max(int x, int y){ return (x > y) ? x : y; }
+  static Size max(Size x, Size y){ return (x > y) ? x : y; }
 
-  void swap(vec<T>& other) {
+  void swap(vec& other) {
     using std::swap;
+    own();
+    other.own();
     swap(data, other.data);
     swap(sz, other.sz);
     swap(cap, other.cap);
@@ -66,35 +92,38 @@ class vec {
 
   // Constructors:
   vec() {}
-  explicit vec(int size) { growTo(size); }
-  vec(int size, const T& pad) { growTo(size, pad); }
+  explicit vec(Size size) { growTo(size); }
+  vec(Size size, const T& pad) { growTo(size, pad); }
   ~vec() { clear(true); }
 
   // Pointer to first element:
   operator T*() { return data; }
 
-  int size() const { return sz; }
+  Size size() const { return sz; }
 
-  void shrink(int nelems) {
+  void shrink(Size nelems) {
     assert(nelems <= sz);
-    for (int i = 0; i < nelems; i++) {
+    for (Size i = 0; i < nelems; i++) {
       sz--;
       data[sz].~T();
     }
   }
 
-  void shrink_(int nelems) {
+  void shrink_(Size nelems) {
     assert(nelems <= sz);
     sz -= nelems;
   }
 
-  int capacity() const {
+  Size capacity() const {
     return cap;
   }
+  uint64_t memoryUsage() const {
+    return (uint64_t)cap * sizeof(T);
+  }
 
-  void capacity(int min_cap);
-  void growTo(int size);
-  void growTo(int size, const T& pad);
+  void capacity(Size min_cap);
+  void growTo(Size size);
+  void growTo(Size size, const T& pad);
   void clear(bool dealloc = false);
 
   // Stack interface:
@@ -124,25 +153,26 @@ class vec {
 
   // NOTE: it seems possible that overflow can happen in the 'sz+1' expression
   // of 'push()', but in fact it can not since it requires that 'cap' is equal
-  // to INT_MAX. This in turn can not happen given the way capacities are
-  // calculated (below). Essentially, all capacities are even, but INT_MAX is
-  // odd.
+  // to 'Max_Size'. This in turn can not happen given the way capacities are
+  // calculated (below). Essentially, all capacities are even, but 'Max_Size'
+  // is odd. (The odd capacities of external storage are small.)
   const T& last() const { return data[sz-1]; }
   T& last() { return data[sz-1]; }
   
   // Vector interface:
-  const T& operator [] (int index) const { return data[index]; }
-  T& operator [] (int index) { return data[index]; }
+  const T& operator [] (Size index) const { return data[index]; }
+  T& operator [] (Size index) { return data[index]; }
 
   // Duplicatation (preferred instead):
-  void copyTo(vec<T>& copy) const {
+  void copyTo(vec& copy) const {
     copy.clear();
     copy.growTo(sz);
-    for (int i = 0; i < sz; i++)
+    for (Size i = 0; i < sz; i++)
       copy[i] = data[i];
   }
 
-  void moveTo(vec<T>& dest) {
+  void moveTo(vec& dest) {
+    own();
     dest.clear(true);
     dest.data = data;
     dest.sz = sz;
@@ -153,55 +183,95 @@ class vec {
   }
 };
 
-template<class T>
-void vec<T>::capacity(int min_cap) {
+template<class T, class SizeT>
+void vec<T, SizeT>::capacity(Size min_cap) {
   if (cap >= min_cap)
     return;
-  // NOTE: grow by approximately 3/2
-  int add = max((min_cap - cap + 1) & ~1, ((cap >> 1) + 2) & ~1);
-  if (add > INT_MAX - cap)
+  // NOTE: grow by approximately 3/2, from an even capacity so that the new one is even too
+  Size old_cap = cap & ~1;
+  Size add = max((min_cap - old_cap + 1) & ~1, ((old_cap >> 1) + 2) & ~1);
+  if (add > Max_Size - old_cap)
     trap("OOM");
-  cap += add;
+  if (external()) {
+    T* p = (T*)::malloc((old_cap + add) * sizeof(T));
+    if (!p)
+      trap("OOM");
+    memcpy(p, data, sz * sizeof(T));
+    data = p;
+    cap = old_cap + add;
+    return;
+  }
+  cap = old_cap + add;
   data = (T*)::realloc(data, cap * sizeof(T));
   if (!data)
     trap("OOM");
  }
 
+template<class T, class SizeT>
+void vec<T, SizeT>::own() {
+  if (!external())
+    return;
+  Size new_cap = (sz + 1) & ~1;
+  T* p = nullptr;
+  if (new_cap > 0) {
+    p = (T*)::malloc(new_cap * sizeof(T));
+    if (!p)
+      trap("OOM");
+    memcpy(p, data, sz * sizeof(T));
+  }
+  data = p;
+  cap = new_cap;
+}
+
 
-template<class T>
-void vec<T>::growTo(int size, const T& pad) {
+template<class T, class SizeT>
+void vec<T, SizeT>::growTo(Size size, const T& pad) {
   if (sz >= size)
     return;
   capacity(size);
-  for (int i = sz; i < size; i++)
+  for (Size i = sz; i < size; i++)
     data[i] = pad;
   sz = size;
 }
 
-template<class T>
-void vec<T>::growTo(int size) {
+template<class T, class SizeT>
+void vec<T, SizeT>::growTo(Size size) {
   if (sz >= size) return;
   capacity(size);
-  for (int i = sz; i < size; i++)
+  for (Size i = sz; i < size; i++)
     new (&data[i]) T();
   sz = size;
 }
 
-template<class T>
-void vec<T>::clear(bool dealloc) {
+template<class T, class SizeT>
+void vec<T, SizeT>::clear(bool dealloc) {
   if (!data)
     return;
 
-  for (int i = 0; i < sz; i++)
+  for (Size i = 0; i < sz; i++)
     data[i].~T();
   sz = 0;
-  if (dealloc) {
+  // External storage stays with the vector:
+  if (dealloc && !external()) {
     free(data);
     data = nullptr;
     cap = 0;
   }
 }
 
+//=================================================================================================
+// A vector with room for 'N' elements in place, for temporaries that are usually small. It moves
+// to the heap once it outgrows them, and when it is moved or swapped. (The room is rounded up to
+// an odd number of elements, which marks it as external storage in 'vec'.)
+
+template<class T, int N, class SizeT = VecSize>
+class svec : public vec<T, SizeT> {
+  alignas(T) char buf[(N | 1) * sizeof(T)];
+
+ public:
+  svec() : vec<T, SizeT>((T*)buf, N | 1) {}
+};
+
 }
 
 #endif
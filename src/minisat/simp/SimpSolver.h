@@ -0,0 +1,209 @@
+/************************************************************************************[SimpSolver.h]
+Copyright (c) 2006,      Niklas Een, Niklas Sorensson
+Copyright (c) 2007-2010, Niklas Sorensson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_SimpSolver_h
+#define Minisat_SimpSolver_h
+
+#include "minisat/mtl/Queue.h"
+#include "minisat/core/Solver.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// SimpSolver -- a Solver with SatELite-style preprocessing:
+
+class SimpSolver : public Solver {
+ public:
+  SimpSolver();
+  ~SimpSolver() override;
+
+  // Problem specification:
+  //
+  // Add a new variable with parameters specifying variable mode.
+  Var newVar(lbool upol = l_Undef, bool dvar = true);
+  void releaseVar(Lit l);
+  // Add a clause to the solver. Eliminated variables in it are reintroduced.
+  bool addClause(vec<Lit> ps);
+  // Add a clause to the solver without making a copy. Note that 'ps' may be
+  // modified.
+  bool addClause_(vec<Lit>& ps);
+  // Add the constraint that at most 'k' of the literals 'ps' are true. Its
+  // variables are frozen. Note that 'ps' may be modified.
+  bool addAtMostK_(vec<Lit>& ps, int k);
+  // Add the constraint that the literals 'ps' have the parity 'rhs'. Its
+  // variables are frozen. Note that 'ps' may be modified.
+  bool addXor_(vec<Lit>& ps, bool rhs);
+
+  // Variable mode:
+  //
+  // If a variable is frozen it will not be eliminated.
+  void setFrozen(Var v, bool b);
+  bool isEliminated(Var v) const;
+
+  // Solving:
+  //
+  bool solve(const vec<Lit>& assumptions = vec<Lit>(),
+             bool do_simp = true, bool turn_off_simp = false);
+  lbool solveLimited(const vec<Lit>& assumptions,
+                     bool do_simp = true, bool turn_off_simp = false);
+  // Perform variable elimination based simplification.
+  bool eliminate(bool turn_off_elim = false);
+
+  // Memory managment:
+  //
+  void garbageCollect() override;
+
+  // Mode of operation:
+  //
+  // Allow a variable elimination step to grow by a number of clauses.
+  // (default 0)
+  int grow;
+
+  // Variables are not eliminated if it produces a resolvent with a length
+  // above this limit. -1 means no limit. (default 20)
+  int clause_lim;
+
+  // Do not check if subsumption against a clause larger than this. -1 means no
+  // limit. (default 1000)
+  int subsumption_lim;
+
+  // The number of candidates that backward subsumption may check in one
+  // 'eliminate()', per literal of the problem clauses. -1 means no limit.
+  // (default 10)
+  int subsumption_effort;
+
+  // A different limit for when to issue a GC during simplification (Also see
+  // 'garbage_frac').
+  double simp_garbage_frac;
+
+  // Shrink clauses by asymmetric branching.
+  bool use_asymm;
+
+  // Check if a clause is already implied. Pretty costly, and subsumes
+  // subsumptions :)
+  bool use_rcheck;
+
+  // Perform variable elimination.
+  bool use_elim;
+
+  // Statistics: (read-only member variable)
+  //
+  uint64_t merges, asymm_lits, eliminated_vars, reintroduced_vars;
+
+ protected:
+  // Helper structures:
+  //
+  struct ElimLt {
+    const LMap<int>& n_occ;
+    explicit ElimLt(const LMap<int>& no) : n_occ(no) {}
+
+    uint64_t cost(Var x) const {
+      return (uint64_t)n_occ[mkLit(x)] * (uint64_t)n_occ[~mkLit(x)];
+    }
+    bool operator()(Var x, Var y) const { return cost(x) < cost(y); }
+  };
+
+  struct ClauseDeleted {
+    const ClauseAllocator& ca;
+    explicit ClauseDeleted(const ClauseAllocator& _ca) : ca(_ca) {}
+    bool operator()(const CRef& cr) const { return ca[cr].mark() == 1; }
+  };
+
+  // Solver state:
+  //
+  bool use_simplification;
+  // Max variable at the point simplification was turned off.
+  Var max_simp_var;
+  // Value of 'equiv_lits' when the occurrence lists were last built.
+  uint64_t occurs_equiv_lits;
+  VMap<char> touched;
+  OccLists<Var, vec<CRef>, ClauseDeleted> occurs;
+  LMap<int> n_occ;
+  Heap<Var,ElimLt> elim_heap;
+  Queue<CRef> subsumption_queue;
+  VMap<char> frozen;
+  VMap<char> eliminated;
+  int bwdsub_assigns;
+  int n_touched;
+  // What is left of the budget of 'subsumption_effort':
+  int64_t subsumption_steps;
+
+  // Temporaries:
+  //
+  CRef bwdsub_tmpunit;
+  vec<Lit> resolvent;
+
+  // Main internal methods:
+  //
+  lbool solve_(const vec<Lit>& assumptions, bool do_simp, bool turn_off_simp);
+  bool asymm(Var v, CRef cr);
+  bool asymmVar(Var v);
+  void updateElimHeap(Var v);
+  void gatherTouchedClauses();
+  bool merge(const Clause& _ps, const Clause& _qs, Var v, vec<Lit>& out_clause);
+  bool merge(const Clause& _ps, const Clause& _qs, Var v, int& size);
+  bool backwardSubsumptionCheck();
+  bool eliminateVar(Var v);
+  // Take the clauses of an eliminated variable off the elimination stack and
+  // add them again.
+  bool reintroduce(Var v);
+  // Rebuild the occurrence lists after equivalent-literal substitution.
+  void rebuildOccurs();
+
+  void removeClause(CRef cr);
+  bool strengthenClause(CRef cr, Lit l);
+  bool implied(const vec<Lit>& c);
+  void relocAll(ClauseAllocator& to);
+};
+
+
+//=================================================================================================
+// Implementation of inline methods:
+
+inline bool SimpSolver::isEliminated(Var v) const { return eliminated[v]; }
+inline void SimpSolver::updateElimHeap(Var v) {
+  assert(use_simplification);
+  if (elim_heap.inHeap(v) ||
+      (!frozen[v] && !isEliminated(v) && value(v) == l_Undef))
+    elim_heap.update(v);
+}
+
+inline bool SimpSolver::addClause(vec<Lit> ps) { return addClause_(ps); }
+
+inline void SimpSolver::setFrozen(Var v, bool b) {
+  frozen[v] = (char)b;
+  if (use_simplification && !b)
+    updateElimHeap(v);
+}
+
+inline bool SimpSolver::solve(const vec<Lit>& assumptions,
+                              bool do_simp, bool turn_off_simp) {
+  budgetOff();
+  return solve_(assumptions, do_simp, turn_off_simp) == l_True;
+}
+
+inline lbool SimpSolver::solveLimited(const vec<Lit>& assumptions,
+                                      bool do_simp, bool turn_off_simp) {
+  return solve_(assumptions, do_simp, turn_off_simp);
+}
+
+}  // namespace Minisat
+
+#endif
@@ -1,41 +1,292 @@
-
 #include "irt/ffi.h"
 #include "irt/irt.h"
 
-#include "minisat/core/Solver.h"
+#include "minisat/simp/SimpSolver.h"
+#include "websat/reorder.h"
+
+Minisat::SimpSolver* g_solver = nullptr;
+
+namespace {
+
+// Until the first 'solve()', clauses are held back in DIMACS form, so that the variables can be
+// numbered by the structure of the formula before the solver sees it (see 'flushPending()').
+struct Pending {
+  int32_t nvars = 0;
+  Minisat::vec<int32_t> lits;
+  // Each at-most-k constraint as 'k' and its literals, followed by 0:
+  Minisat::vec<int32_t> cards;
+  // Each XOR constraint as its parity and its literals, followed by 0:
+  Minisat::vec<int32_t> xors;
+};
+
+bool g_renumber = false;
+bool g_simplify = false;
+int32_t g_verbosity = 0;
+Pending* g_pending = nullptr;
+// The solver's variable for each of the caller's variables:
+Minisat::vec<Minisat::Var>* g_vars = nullptr;
+// The cubes of the last 'generateCubes()' in DIMACS form, each ended by 0:
+Minisat::vec<int32_t>* g_cubes = nullptr;
+
+void create() {
+  g_solver = new Minisat::SimpSolver;
+  g_solver->verbosity = g_verbosity;
+  if (!g_simplify)
+    g_solver->eliminate(true);
+  g_vars = new Minisat::vec<Minisat::Var>;
+  g_cubes = new Minisat::vec<int32_t>;
+  g_pending = g_renumber ? new Pending : nullptr;
+}
+
+void destroy() {
+  delete g_solver;
+  delete g_vars;
+  delete g_cubes;
+  delete g_pending;
+  g_solver = nullptr;
+  g_vars = nullptr;
+  g_cubes = nullptr;
+  g_pending = nullptr;
+}
+
+Minisat::Lit toSolverLit(int32_t x) {
+  return Minisat::mkLit((*g_vars)[(x < 0 ? -x : x) - 1], x < 0);
+}
+
+void flushPending() {
+  // The literals of the constraints are ordered as if they were clauses:
+  Minisat::vec<int32_t>& lits = g_pending->lits;
+  const Minisat::vec<int32_t>& cards = g_pending->cards;
+  const Minisat::vec<int32_t>& xors = g_pending->xors;
+  int nclause_lits = lits.size();
+  for (int i = 0; i < cards.size(); i++) {
+    for (i++; cards[i] != 0; i++)
+      lits.push(cards[i]);
+    lits.push(0);
+  }
+  for (int i = 0; i < xors.size(); i++) {
+    for (i++; xors[i] != 0; i++)
+      lits.push(xors[i]);
+    lits.push(0);
+  }
+
+  Minisat::vec<int32_t> order;
+  cuthillMcKeeOrder(g_pending->nvars, lits, order);
+  g_vars->growTo(g_pending->nvars);
+  for (int i = 0; i < order.size(); i++)
+    (*g_vars)[order[i] - 1] = g_solver->newVar();
+
+  Minisat::svec<Minisat::Lit, 16> c;
+  for (int i = 0; i < nclause_lits; i++) {
+    if (lits[i] != 0) {
+      c.push(toSolverLit(lits[i]));
+      continue;
+    }
+    g_solver->addClause_(c);
+    c.clear();
+  }
+  for (int i = 0; i < cards.size(); i++) {
+    int32_t k = cards[i];
+    for (i++; cards[i] != 0; i++)
+      c.push(toSolverLit(cards[i]));
+    g_solver->addAtMostK_(c, k);
+    c.clear();
+  }
+  for (int i = 0; i < xors.size(); i++) {
+    bool rhs = xors[i];
+    for (i++; xors[i] != 0; i++)
+      c.push(toSolverLit(xors[i]));
+    g_solver->addXor_(c, rhs);
+    c.clear();
+  }
+  delete g_pending;
+  g_pending = nullptr;
+}
+
+}  // namespace
 
-Minisat::Solver* g_solver = nullptr;
 EXPORT void init() {
-  g_solver = new Minisat::Solver;
+  create();
+}
+
+// Whether the solvers created by the following 'reset()'s renumber their variables at the first
+// 'solve()'. Off by default.
+EXPORT void setRenumbering(bool enable) {
+  g_renumber = enable;
+}
+
+// Whether the solvers created by the following 'reset()'s simplify the formula by subsumption and
+// variable elimination. Off by default, since it costs more than it saves on large at-most-one
+// encodings such as sudoku_test's.
+EXPORT void setSimplification(bool enable) {
+  g_simplify = enable;
+}
+
+// Sets the verbosity of this and the following solvers: 1 prints the progress and memory usage
+// after each restart.
+EXPORT void setVerbosity(int32_t level) {
+  g_verbosity = level;
+  if (g_solver)
+    g_solver->verbosity = level;
 }
 
 EXPORT int32_t newLiteral() {
-  return Minisat::toInt(g_solver->newVar()) + 1;
+  if (g_pending)
+    return ++g_pending->nvars;
+  g_vars->push(g_solver->newVar());
+  return g_vars->size();
 }
 
 EXPORT void addClause(int32_t* clause, size_t length) {
-  Minisat::vec<Minisat::Lit> c;
-  for (size_t i = 0; i < length; ++i) {
-    int32_t x = clause[i];
-    c.push(Minisat::mkLit((x < 0 ? -x : x) - 1, x < 0));
+  if (g_pending) {
+    for (size_t i = 0; i < length; ++i)
+      g_pending->lits.push(clause[i]);
+    g_pending->lits.push(0);
+    return;
   }
-  g_solver->addClause(std::move(c));
+
+  Minisat::svec<Minisat::Lit, 16> c;
+  for (size_t i = 0; i < length; ++i)
+    c.push(toSolverLit(clause[i]));
+  g_solver->addClause_(c);
+}
+
+// Adds the constraint that at most 'k' of the literals are true, which the solver propagates
+// natively instead of through a clause encoding.
+EXPORT void addAtMostK(int32_t* lits, size_t length, int32_t k) {
+  if (g_pending) {
+    g_pending->cards.push(k);
+    for (size_t i = 0; i < length; ++i)
+      g_pending->cards.push(lits[i]);
+    g_pending->cards.push(0);
+    return;
+  }
+
+  Minisat::svec<Minisat::Lit, 16> c;
+  for (size_t i = 0; i < length; ++i)
+    c.push(toSolverLit(lits[i]));
+  g_solver->addAtMostK_(c, k);
+}
+
+// Adds the constraint that an odd number of the literals is true if 'rhs' is set, and an even
+// number otherwise. The solver propagates it by Gauss-Jordan elimination with the other XOR
+// constraints.
+EXPORT void addXor(int32_t* lits, size_t length, bool rhs) {
+  if (g_pending) {
+    g_pending->xors.push(rhs);
+    for (size_t i = 0; i < length; ++i)
+      g_pending->xors.push(lits[i]);
+    g_pending->xors.push(0);
+    return;
+  }
+
+  Minisat::svec<Minisat::Lit, 16> c;
+  for (size_t i = 0; i < length; ++i)
+    c.push(toSolverLit(lits[i]));
+  g_solver->addXor_(c, rhs);
 }
 
 EXPORT void reset() {
-  delete g_solver;
-  g_solver = new Minisat::Solver;
+  destroy();
+  create();
 }
 
 EXPORT bool solve() {
+  if (g_pending)
+    flushPending();
   return g_solver->solve();
 }
 
+// Solves under the assumption that the literals are true.
+EXPORT bool solveAssuming(int32_t* lits, size_t length) {
+  if (g_pending)
+    flushPending();
+  Minisat::vec<Minisat::Lit> assumps;
+  for (size_t i = 0; i < length; ++i)
+    assumps.push(toSolverLit(lits[i]));
+  return g_solver->solve(assumps);
+}
+
+// Splits the problem by lookahead into at most 'max_cubes' cubes, to be solved with
+// 'solveAssuming()' by separate workers. Returns the length of the cubes for 'extractCubes()', which
+// is 0 if the problem is unsatisfiable.
+EXPORT size_t generateCubes(int32_t max_cubes) {
+  if (g_pending)
+    flushPending();
+  g_cubes->clear();
+  Minisat::vec<Minisat::vec<Minisat::Lit>> cubes;
+  if (!g_solver->eliminate() || !g_solver->generateCubes(max_cubes, cubes))
+    return 0;
+
+  Minisat::vec<int32_t> caller_var(g_solver->nVars(), 0);
+  for (int i = 0; i < g_vars->size(); i++)
+    caller_var[(*g_vars)[i]] = i + 1;
+  for (int i = 0; i < cubes.size(); i++) {
+    for (int j = 0; j < cubes[i].size(); j++) {
+      Minisat::Lit p = cubes[i][j];
+      g_cubes->push(Minisat::sign(p) ? -caller_var[Minisat::var(p)] : caller_var[Minisat::var(p)]);
+    }
+    g_cubes->push(0);
+  }
+  return g_cubes->size();
+}
+
+EXPORT void extractCubes(int32_t* buf, size_t length) {
+  for (size_t i = 0; i < length; ++i)
+    buf[i] = (*g_cubes)[i];
+}
+
+// Runs local search for up to 'flips' flips from the saved phases, which it replaces by the best
+// assignment found, so that a following 'solve()' starts from there. Returns true if that
+// assignment satisfies the problem, in which case 'extract()' reads it.
+EXPORT bool localSearch(int32_t flips) {
+  if (g_pending)
+    flushPending();
+  return g_solver->eliminate() && g_solver->localSearch(flips) == Minisat::l_True;
+}
+
+// The address of the solver's statistics ('Minisat::Solver::Stats'), which a worker sharing the
+// memory may read at any time, also during 'solve()'. It stays valid until 'reset()'.
+EXPORT const Minisat::Solver::Stats* getStats() {
+  // (websat.js reads the fields by their order in 'STATS_FIELDS'.)
+  static_assert(sizeof(Minisat::Solver::Stats) == 8 + 19 * 8, "update STATS_FIELDS");
+  return &g_solver->stats;
+}
+
+// Fills in the bytes that the solver's data structures take ('Minisat::Solver::MemoryUsage').
+EXPORT void memoryUsage(Minisat::Solver::MemoryUsage* out) {
+  // (websat.js reads the fields by their order in 'MEMORY_FIELDS'.)
+  static_assert(sizeof(Minisat::Solver::MemoryUsage) == 11 * 8, "update MEMORY_FIELDS");
+  g_solver->memoryUsage(*out);
+}
+
+#if defined(MINISAT_PROFILING)
+// The time spent in each phase of the search ('Minisat::Profile'), which stays valid until
+// 'reset()'. Only builds with the GN arg 'profiling' have this and the other profiling exports.
+EXPORT const Minisat::Profile* getProfile() {
+  // (websat.js reads the phases by their order in 'PROFILE_PHASES'.)
+  static_assert(Minisat::Phase_Count == 7, "update PROFILE_PHASES");
+  static_assert(sizeof(Minisat::Profile::Event) == 16, "update traceJSON()");
+  return &g_solver->profile;
+}
+
+// Starts recording the beginning and end of each phase afresh, or stops.
+EXPORT void setTracing(bool enable) {
+  g_solver->profile.setTracing(enable);
+}
+
+// The ring buffer of recorded 'Minisat::Profile::Event's, or null while not tracing.
+EXPORT const Minisat::Profile::Event* getTraceEvents() {
+  const Minisat::Profile& profile = g_solver->profile;
+  return profile.tracing() ? &profile.events[0] : nullptr;
+}
+#endif
+
 EXPORT size_t getNVars() {
-  return g_solver->nVars();
+  return g_pending ? g_pending->nvars : g_vars->size();
 }
 
 EXPORT void extract(uint8_t* buf, size_t length) {
   for (size_t i = 0; i < length; ++i)
-    buf[i] = toInt(g_solver->modelValue(i));
+    buf[i] = toInt(g_solver->modelValue((*g_vars)[i]));
 }
@@ -0,0 +1,124 @@
+#include "irt/ffi.h"
+#include "irt/irt.h"
+
+#include "minisat/core/SolverTypes.h"
+#include "minisat/mtl/Heap.h"
+
+// Microbenchmarks for the variable order heaps. Each operation replays what the solver does to
+// 'order_heap' on random activities, and the driver (heap_bench.js) times the calls.
+
+namespace {
+
+using Minisat::Var;
+
+struct ActivityLt {
+  const Minisat::IntMap<Var, double>& activity;
+  bool operator()(Var x, Var y) const { return activity[x] > activity[y]; }
+  ActivityLt(const Minisat::IntMap<Var, double>& act) : activity(act) {}
+};
+
+struct ActivityPrio {
+  typedef double Value;
+  const Minisat::IntMap<Var, double>& activity;
+  Value operator()(Var x) const { return activity[x]; }
+  static bool lt(Value x, Value y) { return x > y; }
+  ActivityPrio(const Minisat::IntMap<Var, double>& act) : activity(act) {}
+};
+
+struct Bench {
+  Minisat::IntMap<Var, double> activity;
+  Minisat::Heap<Var, ActivityLt> binary_heap;
+  Minisat::CachedHeap<Var, ActivityPrio> cached_heap;
+  int vars;
+  double inc = 1;
+  uint32_t seed;
+
+  Bench(int32_t _vars, uint32_t _seed)
+      : binary_heap(ActivityLt(activity)),
+        cached_heap(ActivityPrio(activity)),
+        vars(_vars),
+        seed(_seed ? _seed : 1) {}
+
+  uint32_t next() {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+  }
+};
+
+Bench* g_bench = nullptr;
+
+void refresh(Minisat::Heap<Var, ActivityLt>&) {}
+void refresh(Minisat::CachedHeap<Var, ActivityPrio>& heap) { heap.refresh(); }
+
+template<class H>
+void insertAll(H& heap) {
+  heap.clear();
+  for (Var v = 0; v < g_bench->vars; v++)
+    heap.insert(v);
+}
+
+template<class H>
+void bumpRandom(H& heap, int32_t rounds) {
+  Bench& b = *g_bench;
+  for (int32_t i = 0; i < rounds; i++) {
+    Var v = b.next() % b.vars;
+    if ((b.activity[v] += b.inc) > 1e100) {
+      for (Var x = 0; x < b.vars; x++)
+        b.activity[x] *= 1e-100;
+      b.inc *= 1e-100;
+      refresh(heap);
+    }
+    // Decay about once per conflict:
+    if (i % 64 == 63)
+      b.inc *= 1 / 0.95;
+    if (heap.inHeap(v))
+      heap.decrease(v);
+  }
+}
+
+template<class H>
+uint32_t removeAll(H& heap) {
+  // Hash the activities rather than the variables, which ties may reorder:
+  uint32_t sum = 0;
+  while (!heap.empty()) {
+    uint64_t bits;
+    memcpy(&bits, &g_bench->activity[heap.removeMin()], sizeof(bits));
+    sum = sum * 31 + (uint32_t)(bits ^ (bits >> 32));
+  }
+  return sum;
+}
+
+}  // namespace
+
+// Starts over with empty heaps, and gives 'vars' variables random activities.
+EXPORT void benchInit(int32_t vars, uint32_t seed) {
+  delete g_bench;
+  g_bench = new Bench(vars, seed);
+  g_bench->activity.reserve(vars - 1, 0);
+  for (Var v = 0; v < vars; v++)
+    g_bench->activity[v] = g_bench->next() / 4294967296.0;
+}
+
+// 'kind' selects the heap: 0 for the binary 'Heap', 1 for the 4-ary 'CachedHeap'.
+EXPORT void benchInsert(int32_t kind) {
+  if (kind == 0)
+    insertAll(g_bench->binary_heap);
+  else
+    insertAll(g_bench->cached_heap);
+}
+
+EXPORT void benchDecrease(int32_t kind, int32_t rounds) {
+  if (kind == 0)
+    bumpRandom(g_bench->binary_heap, rounds);
+  else
+    bumpRandom(g_bench->cached_heap, rounds);
+}
+
+// Returns a checksum of the removal order, which is the same for both heaps.
+EXPORT uint32_t benchRemoveMin(int32_t kind) {
+  if (kind == 0)
+    return removeAll(g_bench->binary_heap);
+  return removeAll(g_bench->cached_heap);
+}
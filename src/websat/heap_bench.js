@@ -0,0 +1,48 @@
+import {instantiate} from "./websat.js";
+
+testRunner.waitUntilDone();
+
+function now() {
+  return typeof performance !== 'undefined' ? performance.now() : Date.now();
+}
+
+// Usage: heap_bench [vars] [repeat]
+(async (vars = 100000, repeat = 5) => {
+  vars = Number(vars);
+  repeat = Number(repeat);
+  let {instance} = await instantiate('heap_bench.wasm');
+  let bench = instance.exports;
+
+  let kinds = ['binary', '4-ary cached'];
+  let checksums = [];
+  for (let kind = 0; kind < kinds.length; kind++) {
+    let best = {insert: Infinity, decrease: Infinity, removeMin: Infinity};
+    for (let i = 0; i < repeat; i++) {
+      bench.benchInit(vars, 1);
+      let t0 = now();
+      bench.benchInsert(kind);
+      let t1 = now();
+      bench.benchDecrease(kind, vars * 10);
+      let t2 = now();
+      checksums[kind] = bench.benchRemoveMin(kind);
+      let t3 = now();
+      best.insert = Math.min(best.insert, t1 - t0);
+      best.decrease = Math.min(best.decrease, t2 - t1);
+      best.removeMin = Math.min(best.removeMin, t3 - t2);
+    }
+    print(`${kinds[kind]}: insert ${best.insert.toFixed(2)}ms, ` +
+          `decrease ${best.decrease.toFixed(2)}ms, ` +
+          `removeMin ${best.removeMin.toFixed(2)}ms`);
+  }
+  if (checksums[0] !== checksums[1]) {
+    print('removal order differs');
+  }
+})(...arguments).catch(e => {
+  if (e instanceof Error) {
+    print(e.stack);
+  } else {
+    print(e);
+  }
+}).finally(() => {
+  testRunner.notifyDone();
+});
@@ -0,0 +1,80 @@
+#include "websat/reorder.h"
+
+#include "minisat/mtl/Sort.h"
+
+namespace {
+
+struct DegreeLt {
+  const Minisat::vec<int32_t>& degree;
+  bool operator()(int32_t x, int32_t y) const {
+    return degree[x] < degree[y] || (degree[x] == degree[y] && x < y);
+  }
+  DegreeLt(const Minisat::vec<int32_t>& d) : degree(d) {}
+};
+
+}  // namespace
+
+void cuthillMcKeeOrder(int32_t nvars, const Minisat::vec<int32_t>& lits,
+                       Minisat::vec<int32_t>& order) {
+  // Occurrences of each variable, as offsets of the clauses in 'lits':
+  Minisat::vec<int32_t> degree(nvars + 1, 0);
+  Minisat::vec<int32_t> start(nvars + 2, 0);
+  for (int i = 0; i < lits.size(); i++) {
+    if (lits[i] != 0)
+      degree[lits[i] < 0 ? -lits[i] : lits[i]]++;
+  }
+  for (int32_t v = 1; v <= nvars; v++)
+    start[v + 1] = start[v] + degree[v];
+  Minisat::vec<int32_t> occs(start[nvars + 1]);
+  Minisat::vec<int32_t> fill(nvars + 1, 0);
+  for (int i = 0, c = 0; i < lits.size(); i++) {
+    if (lits[i] == 0) {
+      c = i + 1;
+      continue;
+    }
+    int32_t v = lits[i] < 0 ? -lits[i] : lits[i];
+    occs[start[v] + fill[v]++] = c;
+  }
+
+  // Components are started from their variables of least degree; unused variables go last:
+  Minisat::vec<int32_t> roots;
+  for (int32_t v = 1; v <= nvars; v++)
+    roots.push(v);
+  Minisat::sort(roots, DegreeLt(degree));
+
+  Minisat::vec<char> numbered(nvars + 1, 0);
+  Minisat::vec<char> expanded(lits.size() + 1, 0);
+  Minisat::vec<int32_t> next;
+  order.clear();
+  for (int r = 0; r < roots.size(); r++) {
+    if (degree[roots[r]] == 0 || numbered[roots[r]])
+      continue;
+    int head = order.size();
+    numbered[roots[r]] = 1;
+    order.push(roots[r]);
+    while (head < order.size()) {
+      int32_t v = order[head++];
+      next.clear();
+      for (int k = start[v]; k < start[v + 1]; k++) {
+        int32_t c = occs[k];
+        if (expanded[c])
+          continue;
+        expanded[c] = 1;
+        for (int i = c; lits[i] != 0; i++) {
+          int32_t u = lits[i] < 0 ? -lits[i] : lits[i];
+          if (!numbered[u]) {
+            numbered[u] = 1;
+            next.push(u);
+          }
+        }
+      }
+      Minisat::sort(next, DegreeLt(degree));
+      for (int i = 0; i < next.size(); i++)
+        order.push(next[i]);
+    }
+  }
+  for (int32_t v = 1; v <= nvars; v++) {
+    if (!numbered[v])
+      order.push(v);
+  }
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "irt/types.h"
+#include "minisat/mtl/Vec.h"
+
+// Orders the variables '1 .. nvars' of a formula by Cuthill-McKee on its variable interaction
+// graph, so that variables sharing clauses end up close to each other. 'lits' holds the clauses
+// in DIMACS form, each ended by 0. On return, 'order[i]' is the variable to number 'i'.
+void cuthillMcKeeOrder(int32_t nvars, const Minisat::vec<int32_t>& lits,
+                       Minisat::vec<int32_t>& order);
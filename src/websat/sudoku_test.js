@@ -5,11 +5,7 @@ testRunner.waitUntilDone();
 
 function exclusive(solver, xs) {
   solver.addClause(...xs);
-  for (let i = 0; i < xs.length; ++i) {
-    for (let j = i + 1; j < xs.length; ++j) {
-      solver.addClause(-xs[i], -xs[j]);
-    }
-  }
+  solver.addAtMostK(1, ...xs);
 }
 
 (async () => {
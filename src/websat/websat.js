@@ -3,15 +3,18 @@ import {loadWasm} from "./wasm_loader.js";
 import {encodeUTF8, decodeUTF8} from "./text_decoder.js";
 
 function readText(memory, address, length) {
-  return decodeUTF8(new Uint8Array(memory.buffer, address, length));
+  return decodeUTF8(new Uint8Array(memory.buffer, Number(address), Number(length)));
 }
 
-export async function loadSolver() {
-  let module = await loadWasm('websat.wasm');
+// Instantiates the module at 'url' with the runtime's imports, and returns the instance with the
+// memory it runs in.
+export async function instantiate(url) {
+  let module = await loadWasm(url);
   let memory = new WebAssembly.Memory({initial: 2});
   let env = {
     memory: memory,
     pow: Math.pow,
+    now: () => typeof performance !== 'undefined' ? performance.now() : Date.now(),
     print: (address, length) => print(readText(memory, address, length)),
     throwError: (msg, msg_len, filename, filename_len, lineno) => {
       throw new Error();
@@ -20,14 +23,72 @@ export async function loadSolver() {
                       lineno);
     }
   };
-  let instance = await WebAssembly.instantiate(module, {env});
-  return new WebSAT(memory, instance);
+  let memory64 = false;
+  let instance;
+  try {
+    instance = await WebAssembly.instantiate(module, {env});
+  } catch (e) {
+    if (!(e instanceof WebAssembly.LinkError)) {
+      throw e;
+    }
+    // A wasm64 build imports a memory64 memory.
+    memory64 = true;
+    memory = env.memory = new WebAssembly.Memory({initial: 2n, address: 'i64'});
+    instance = await WebAssembly.instantiate(module, {env});
+  }
+  return {memory, instance, memory64};
+}
+
+// The layout of the solver's statistics: a 32-bit 'version' and 'size', followed by these fields as
+// 64-bit unsigned integers (see 'Solver::Stats').
+export const STATS_VERSION = 1;
+export const STATS_FIELDS = [
+  'solves', 'starts', 'restarts', 'decisions', 'rnd_decisions', 'propagations', 'conflicts',
+  'vars', 'dec_vars', 'num_clauses', 'num_learnts', 'clauses_literals', 'learnts_literals',
+  'max_literals', 'tot_literals',
+  'reduce_dbs', 'garbage_collections', 'arena_bytes', 'arena_wasted_bytes',
+];
+
+// Reads the statistics at 'address' (from statsAddress()) in 'memory'. A monitoring worker that
+// shares the memory can call this while the solver runs, and take rates such as conflicts per
+// second from the difference of two readings.
+export function readStats(memory, address) {
+  let view = new DataView(memory.buffer, Number(address));
+  let version = view.getUint32(0, true);
+  if (version !== STATS_VERSION) {
+    throw new Error(`unknown statistics version ${version}`);
+  }
+  let stats = {};
+  STATS_FIELDS.forEach((name, i) => {
+    stats[name] = Number(view.getBigUint64(8 + 8 * i, true));
+  });
+  return stats;
+}
+
+// The fields of the memory usage, in bytes (see 'Solver::MemoryUsage').
+export const MEMORY_FIELDS = [
+  'clauses', 'learnts', 'arena_other', 'arena_wasted', 'arena_free', 'clause_lists', 'watches',
+  'variables', 'trail', 'constraints', 'total',
+];
+
+// The phases that a build with the GN arg 'profiling' times, in the order of 'ProfilePhase', and
+// the number of events its trace keeps.
+export const PROFILE_PHASES = [
+  'solve', 'propagate', 'analyze', 'pickBranchLit', 'reduceDB', 'simplify', 'garbageCollect',
+];
+const TRACE_CAPACITY = 1 << 16;
+
+export async function loadSolver() {
+  let {memory, instance, memory64} = await instantiate('websat.wasm');
+  return new WebSAT(memory, instance, memory64);
 }
 
 export class WebSAT {
-  constructor(memory, solver) {
+  constructor(memory, solver, memory64 = false) {
     this.memory = memory;
     this.solver = solver;
+    // Pointers and sizes are BigInts on memory64.
+    this.size = memory64 ? BigInt : Number;
     this.solver.exports.init();
   }
 
@@ -37,7 +98,7 @@ export class WebSAT {
 
   addClause(...literals) {
     let length = literals.length;
-    let address = this.solver.exports.malloc(length * 4);
+    let address = Number(this.solver.exports.malloc(this.size(length * 4)));
     if (address === 0) {
       throw new Error("OOM");
     }
@@ -46,34 +107,225 @@ export class WebSAT {
     buf.set(literals);
     buf = null;
 
-    this.solver.exports.addClause(address, length);
-    this.solver.exports.free(address);
+    this.solver.exports.addClause(this.size(address), this.size(length));
+    this.solver.exports.free(this.size(address));
+  }
+
+  // Adds the constraint that at most 'k' of the literals are true.
+  addAtMostK(k, ...literals) {
+    let length = literals.length;
+    let address = Number(this.solver.exports.malloc(this.size(length * 4)));
+    if (address === 0) {
+      throw new Error("OOM");
+    }
+
+    let buf = new Int32Array(this.memory.buffer, address, length);
+    buf.set(literals);
+    buf = null;
+
+    this.solver.exports.addAtMostK(this.size(address), this.size(length), k);
+    this.solver.exports.free(this.size(address));
+  }
+
+  // Adds the constraint that an odd number of the literals are true if 'rhs' is true, and an even
+  // number if it is false.
+  addXor(rhs, ...literals) {
+    let length = literals.length;
+    let address = Number(this.solver.exports.malloc(this.size(length * 4)));
+    if (address === 0) {
+      throw new Error("OOM");
+    }
+
+    let buf = new Int32Array(this.memory.buffer, address, length);
+    buf.set(literals);
+    buf = null;
+
+    this.solver.exports.addXor(this.size(address), this.size(length), rhs);
+    this.solver.exports.free(this.size(address));
+  }
+
+  // Solves under the assumption that the given literals are true.
+  solve(...assumptions) {
+    if (assumptions.length === 0) {
+      return this.solver.exports.solve();
+    }
+
+    let length = assumptions.length;
+    let address = Number(this.solver.exports.malloc(this.size(length * 4)));
+    if (address === 0) {
+      throw new Error("OOM");
+    }
+
+    let buf = new Int32Array(this.memory.buffer, address, length);
+    buf.set(assumptions);
+    buf = null;
+
+    let res = this.solver.exports.solveAssuming(this.size(address), this.size(length));
+    this.solver.exports.free(this.size(address));
+    return res;
+  }
+
+  // Splits the problem into at most 'maxCubes' cubes, arrays of literals that cover all models
+  // between them, for workers that load the same problem to solve(...cube) in parallel. Returns
+  // no cubes if the problem is unsatisfiable.
+  generateCubes(maxCubes) {
+    let length = Number(this.solver.exports.generateCubes(maxCubes));
+    if (length === 0) {
+      return [];
+    }
+    let address = Number(this.solver.exports.malloc(this.size(length * 4)));
+    if (address === 0) {
+      throw new Error("OOM");
+    }
+
+    this.solver.exports.extractCubes(this.size(address), this.size(length));
+    let buf = new Int32Array(this.memory.buffer, address, length);
+    let res = [];
+    let cube = [];
+    for (let x of buf) {
+      if (x === 0) {
+        res.push(cube);
+        cube = [];
+      } else {
+        cube.push(x);
+      }
+    }
+    buf = null;
+    this.solver.exports.free(this.size(address));
+    return res;
   }
 
-  solve() {
-    return this.solver.exports.solve();
+  // Runs local search for up to 'flips' flips, and returns whether it found a model for
+  // extract(). Either way, the best assignment found guides the next solve().
+  localSearch(flips) {
+    return this.solver.exports.localSearch(flips);
   }
 
   extract() {
-    let length = this.solver.exports.getNVars();
-    let address = this.solver.exports.malloc(length * 4);
+    let length = Number(this.solver.exports.getNVars());
+    let address = Number(this.solver.exports.malloc(this.size(length * 4)));
     if (address === 0) {
       throw new Error("OOM");
     }
 
     let m = ['true', 'false', 'undef'];
     let res = ['undef'];
-    this.solver.exports.extract(address, length);
+    this.solver.exports.extract(this.size(address), this.size(length));
     let buf = new Uint8Array(this.memory.buffer, address, length);
     for (let v of buf) {
       res.push(m[v]);
     }
     buf = null;
-    this.solver.exports.free(address);
+    this.solver.exports.free(this.size(address));
     return res;
   }
 
+  // The address of the statistics for readStats(), which stays valid until reset().
+  statsAddress() {
+    return this.solver.exports.getStats();
+  }
+
+  stats() {
+    return readStats(this.memory, this.statsAddress());
+  }
+
+  // The bytes that the solver's data structures take, by what they hold.
+  memoryUsage() {
+    let length = MEMORY_FIELDS.length * 8;
+    let address = Number(this.solver.exports.malloc(this.size(length)));
+    if (address === 0) {
+      throw new Error("OOM");
+    }
+
+    this.solver.exports.memoryUsage(this.size(address));
+    let view = new DataView(this.memory.buffer, address, length);
+    let res = {};
+    MEMORY_FIELDS.forEach((name, i) => {
+      res[name] = Number(view.getBigUint64(8 * i, true));
+    });
+    view = null;
+    this.solver.exports.free(this.size(address));
+    return res;
+  }
+
+  // Prints the progress and memory usage after each restart if 'level' is 1 or more. This lasts
+  // across reset().
+  setVerbosity(level) {
+    this.solver.exports.setVerbosity(level);
+  }
+
+  // The time spent in each phase as {phase: {ms, count}}, where the time of a phase includes the
+  // phases inside it. Null if the build does not profile.
+  profile() {
+    if (!this.solver.exports.getProfile) {
+      return null;
+    }
+    let view = new DataView(this.memory.buffer, Number(this.solver.exports.getProfile()));
+    let n = PROFILE_PHASES.length;
+    let res = {};
+    PROFILE_PHASES.forEach((name, i) => {
+      res[name] = {
+        ms: view.getFloat64(8 * i, true),
+        count: Number(view.getBigUint64(8 * (n + i), true)),
+      };
+    });
+    return res;
+  }
+
+  // Starts recording the phases for traceJSON() afresh, or stops.
+  setTracing(enable) {
+    if (!this.solver.exports.setTracing) {
+      throw new Error("not a profiling build");
+    }
+    this.solver.exports.setTracing(enable);
+  }
+
+  // The latest recorded phases in the Chrome trace event format, for chrome://tracing or Perfetto.
+  traceJSON() {
+    let traceEvents = [];
+    let address = this.solver.exports.getTraceEvents ?
+        Number(this.solver.exports.getTraceEvents()) : 0;
+    if (address !== 0) {
+      let profile = new DataView(this.memory.buffer, Number(this.solver.exports.getProfile()));
+      let recorded = Number(profile.getBigUint64(16 * PROFILE_PHASES.length, true));
+      let first = Math.max(recorded - TRACE_CAPACITY, 0);
+      let events = new DataView(this.memory.buffer, address, TRACE_CAPACITY * 16);
+      let depth = 0;
+      for (let i = first; i < recorded; i++) {
+        let at = (i % TRACE_CAPACITY) * 16;
+        let begin = events.getUint32(at + 12, true) !== 0;
+        // The oldest events may end phases whose beginning was overwritten:
+        if (!begin && depth === 0) {
+          continue;
+        }
+        depth += begin ? 1 : -1;
+        traceEvents.push({
+          name: PROFILE_PHASES[events.getUint32(at + 8, true)],
+          ph: begin ? 'B' : 'E',
+          ts: events.getFloat64(at, true) * 1000,
+          pid: 1,
+          tid: 1,
+        });
+      }
+    }
+    return JSON.stringify({traceEvents, displayTimeUnit: 'ms'});
+  }
+
   reset() {
     this.solver.exports.reset();
   }
+
+  // Starts over with a solver that renumbers the variables by the structure of the formula at the
+  // first solve(), or one that does not. Literals and models are unaffected.
+  setRenumbering(enable) {
+    this.solver.exports.setRenumbering(enable);
+    this.solver.exports.reset();
+  }
+
+  // Starts over with a solver that simplifies the formula by subsumption and variable elimination
+  // before solving, or one that does not (the default).
+  setSimplification(enable) {
+    this.solver.exports.setSimplification(enable);
+    this.solver.exports.reset();
+  }
 }
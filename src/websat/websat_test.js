@@ -9,6 +9,59 @@ testRunner.waitUntilDone();
   solver.addClause(x);
   print(solver.solve());
   print(solver.extract());
+
+  solver.setRenumbering(true);
+  let [a, b, c] = [solver.newLiteral(), solver.newLiteral(), solver.newLiteral()];
+  solver.addClause(-a, b);
+  solver.addClause(c);
+  solver.addClause(-c, a);
+  print(solver.solve());
+  print(solver.extract());
+
+  solver.setRenumbering(false);
+  let ys = [solver.newLiteral(), solver.newLiteral(), solver.newLiteral()];
+  solver.addAtMostK(1, ...ys);
+  solver.addClause(ys[0], ys[1]);
+  solver.addClause(ys[1], ys[2]);
+  print(solver.solve());
+  print(solver.extract());
+
+  let zs = [solver.newLiteral(), solver.newLiteral(), solver.newLiteral()];
+  solver.addXor(true, ...zs);
+  solver.addXor(false, zs[0], zs[1]);
+  solver.addXor(false, zs[1], -zs[2]);
+  print(solver.solve());
+  print(solver.extract());
+
+  solver.reset();
+  let ws = [];
+  for (let i = 0; i < 6; i++) {
+    ws.push(solver.newLiteral());
+  }
+  for (let i = 0; i < 6; i++) {
+    solver.addClause(ws[i], ws[(i + 1) % 6], -ws[(i + 2) % 6]);
+    solver.addClause(-ws[i], -ws[(i + 3) % 6]);
+  }
+  let cubes = solver.generateCubes(4);
+  print(cubes.length);
+  print(cubes.map(cube => solver.solve(...cube)));
+
+  solver.setSimplification(true);
+  let vs = [];
+  for (let i = 0; i < 8; i++) {
+    vs.push(solver.newLiteral());
+  }
+  for (let i = 0; i < 8; i++) {
+    solver.addClause(vs[i], -vs[(i + 1) % 8], vs[(i + 3) % 8]);
+    solver.addClause(-vs[i], vs[(i + 2) % 8]);
+  }
+  print(solver.localSearch(1000));
+  print(solver.extract());
+  print(solver.solve());
+  let stats = solver.stats();
+  print(stats.solves, stats.vars, stats.num_clauses);
+  let mem = solver.memoryUsage();
+  print(mem.total >= mem.watches + mem.variables);
 })().catch(e => {
   if (e instanceof Error) {
     print(e.stack);